@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "include/SpecializedADT/Queue.hpp"
+#include "include/SpecializedADT/Deque.hpp"
+
+// Steady-state FIFO: keep `depth` items queued and cycle `operations`
+// enqueue/dequeue pairs through it.
+template <typename Storage>
+double RunQueue(int depth, long long operations, long long &checksum)
+{
+    Queue<int, Storage> queue;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < depth; ++i)
+    {
+        queue.Enqueue(i);
+    }
+    checksum = 0;
+    for (long long op = 0; op < operations; ++op)
+    {
+        int item = queue.Dequeue();
+        checksum += item;
+        queue.Enqueue(item + 1);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+// Work-list pattern: push at the back, take from alternating ends.
+template <typename Storage>
+double RunDeque(int depth, long long operations, long long &checksum)
+{
+    Deque<int, Storage> deque;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < depth; ++i)
+    {
+        deque.PushBack(i);
+    }
+    checksum = 0;
+    for (long long op = 0; op < operations; ++op)
+    {
+        int item = (op & 1) ? deque.PopBack() : deque.PopFront();
+        checksum += item + deque.PeekFront();
+        if (op & 2)
+            deque.PushFront(item + 1);
+        else
+            deque.PushBack(item + 1);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+template <typename Storage>
+void Report(const char *name, int depth, long long operations, long long expected)
+{
+    long long queueSum = 0;
+    long long dequeSum = 0;
+    double queueMs = RunQueue<Storage>(depth, operations, queueSum);
+    double dequeMs = RunDeque<Storage>(depth, operations, dequeSum);
+    if (expected >= 0 && queueSum != expected)
+    {
+        std::cerr << "Checksum mismatch for " << name << "\n";
+        std::exit(1);
+    }
+    std::cout << "  " << name << ": Queue " << queueMs << " ms ("
+              << queueMs * 1e6 / operations << " ns/op), Deque " << dequeMs << " ms ("
+              << dequeMs * 1e6 / operations << " ns/op)\n";
+}
+
+void RunDepth(int depth, long long operations)
+{
+    long long expected = 0;
+    RunQueue<RingStorage<int>>(depth, operations, expected);
+
+    std::cout << "depth " << depth << ", " << operations << " ops:\n";
+    // The pre-policy adapters: virtual calls into a heap-allocated
+    // ArrayMutableSequence, whose front removal shifts the whole array.
+    if (static_cast<long long>(depth) * operations <= 2000000000LL)
+        Report<VirtualStorage<int>>("virtual ArrayMutableSequence", depth, operations, expected);
+    else
+        std::cout << "  virtual ArrayMutableSequence: skipped (O(n) dequeue)\n";
+    Report<VirtualStorage<int, SegmentedDeque<int>>>("virtual SegmentedDeque", depth, operations, expected);
+    Report<RingStorage<int>>("RingStorage", depth, operations, expected);
+    Report<ArrayStorage<int>>("ArrayStorage", depth, operations, expected);
+    Report<SegmentedStorage<int>>("SegmentedStorage", depth, operations, expected);
+    if (depth <= 1000)
+        Report<ListStorage<int>>("ListStorage", depth, operations, expected);
+    else
+        std::cout << "  ListStorage: skipped (O(n) PopBack)\n";
+}
+
+int main(int argc, char **argv)
+{
+    long long operations = argc > 1 ? std::atoll(argv[1]) : 10000000;
+    for (int depth : {16, 1024, 65536})
+    {
+        RunDepth(depth, operations);
+    }
+    return 0;
+}
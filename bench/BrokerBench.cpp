@@ -0,0 +1,236 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "include/Network/Broker.hpp"
+#include "include/Network/Framing.hpp"
+
+// Loopback fan-out: one publisher connection sends `messages` messages of
+// `size` bytes to one topic while `subscribers` connections are subscribed
+// to it. Reports the publish rate, the delivered rate summed over all
+// subscribers, and how many messages each writev carried.
+//
+// Then an overload run: the publisher sends as fast as it can to a
+// subscriber that reads 16 KiB per millisecond, without and with a high
+// watermark of 4096 messages, and reports the largest backlog held by the
+// broker (published but not yet written to the subscriber's socket) and how
+// long the publisher spent paused.
+// Usage: BrokerBench [messages] [size] [subscriber counts...]
+
+using Clock = std::chrono::steady_clock;
+
+int Connect(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        std::exit(1);
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+void SendAll(int fd, std::string_view bytes)
+{
+    while (!bytes.empty())
+    {
+        ssize_t count = send(fd, bytes.data(), bytes.size(), 0);
+        if (count < 0)
+        {
+            perror("send");
+            std::exit(1);
+        }
+        bytes.remove_prefix(count);
+    }
+}
+
+void Run(int messages, int size, int subscriberCount)
+{
+    Broker::Options options;
+    options.server.port = 0;
+    options.retention.maxCount = messages;
+    Broker broker(options);
+    broker.Start();
+
+    std::vector<int> sockets;
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "bench", "", 0);
+    for (int i = 0; i < subscriberCount; ++i)
+    {
+        sockets.push_back(Connect(broker.GetPort()));
+        SendAll(sockets.back(), subscribe);
+    }
+    while (broker.GetStats().subscribed < subscriberCount)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::atomic<long long> received{0};
+    std::vector<std::thread> readers;
+    for (int fd : sockets)
+    {
+        readers.emplace_back([&, fd]
+                             {
+                                 ReceiveRing ring(256 * 1024);
+                                 FrameDecoder decoder;
+                                 long long count = 0;
+                                 long long last = -1;
+                                 while (last < messages - 1 && ring.FillFrom(fd) > 0)
+                                 {
+                                     decoder.Drain(ring, [&](std::string_view payload)
+                                                   {
+                                                       TopicFrame frame;
+                                                       ParseTopicFrame(payload, frame);
+                                                       last = frame.offset;
+                                                       ++count;
+                                                   });
+                                 }
+                                 received.fetch_add(count);
+                             });
+    }
+
+    std::string body(size, 'p');
+    std::string frames;
+    const int chunk = 256;
+    int publisher = Connect(broker.GetPort());
+    auto start = Clock::now();
+    for (int sent = 0; sent < messages; sent += chunk)
+    {
+        frames.clear();
+        for (int i = sent; i < std::min(messages, sent + chunk); ++i)
+        {
+            AppendTopicFrame(frames, FrameKind::Publish, "bench", body);
+        }
+        SendAll(publisher, frames);
+    }
+    while (broker.GetStats().published < messages)
+    {
+        std::this_thread::yield();
+    }
+    double publishSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Broker::Stats stats = broker.GetStats();
+    std::cout << "1 -> " << subscriberCount << " subscribers, " << messages << " x " << size << " B: published "
+              << messages / publishSeconds / 1000 << "k msg/s, delivered " << received.load() / seconds / 1000
+              << "k msg/s (" << received.load() * static_cast<double>(size) / seconds / (1024 * 1024)
+              << " MiB/s of bodies), " << static_cast<double>(stats.delivered) / stats.writes
+              << " msgs per writev\n";
+    close(publisher);
+    for (int fd : sockets)
+    {
+        close(fd);
+    }
+    broker.Stop();
+}
+
+void RunOverload(int messages, int size, int highWatermark)
+{
+    Broker::Options options;
+    options.server.port = 0;
+    options.highWatermark = highWatermark;
+    Broker broker(options);
+    broker.Start();
+
+    int subscriber = Connect(broker.GetPort());
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "bench", "", 0);
+    SendAll(subscriber, subscribe);
+    while (broker.GetStats().subscribed < 1)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::thread reader([&]
+                       {
+                           ReceiveRing ring(16 * 1024);
+                           FrameDecoder decoder;
+                           long long count = 0;
+                           while (count < messages && ring.FillFrom(subscriber) > 0)
+                           {
+                               decoder.Drain(ring, [&](std::string_view) { ++count; });
+                               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                           }
+                       });
+
+    std::atomic<bool> done{false};
+    long long peak = 0;
+    std::thread sampler([&]
+                        {
+                            while (!done.load())
+                            {
+                                Broker::Stats stats = broker.GetStats();
+                                peak = std::max(peak, stats.published - stats.delivered);
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            }
+                        });
+
+    std::string body(size, 'p');
+    std::string frames;
+    int publisher = Connect(broker.GetPort());
+    auto start = Clock::now();
+    for (int sent = 0; sent < messages; sent += 256)
+    {
+        frames.clear();
+        for (int i = sent; i < std::min(messages, sent + 256); ++i)
+        {
+            AppendTopicFrame(frames, FrameKind::Publish, "bench", body);
+        }
+        SendAll(publisher, frames);
+    }
+    reader.join();
+    done.store(true);
+    sampler.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    StreamServer::Stats server = broker.GetServerStats();
+    std::cout << "overload, " << messages << " x " << size << " B, high watermark " << highWatermark
+              << ": peak backlog " << peak << " msgs (" << peak * size / 1024 << " KiB), publisher paused "
+              << server.pauses << " times for " << server.pausedMicroseconds / 1000 << " of "
+              << static_cast<long long>(seconds * 1000) << " ms\n";
+    close(publisher);
+    close(subscriber);
+    broker.Stop();
+}
+
+int main(int argc, char **argv)
+{
+    int messages = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int size = argc > 2 ? std::atoi(argv[2]) : 64;
+    std::vector<int> counts;
+    for (int i = 3; i < argc; ++i)
+    {
+        counts.push_back(std::atoi(argv[i]));
+    }
+    if (counts.empty())
+        counts = {1, 4, 16};
+    for (int count : counts)
+    {
+        Run(messages, size, count);
+    }
+    for (int highWatermark : {0, 4096})
+    {
+        RunOverload(messages / 4, size, highWatermark);
+    }
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "include/SpecializedADT/ConcurrentSegmentedDeque.hpp"
+
+// Baseline: a segmented std::deque behind one global mutex.
+template <typename T>
+class GlobalLockDeque
+{
+private:
+    std::deque<T> items;
+    std::mutex mutex;
+
+public:
+    void PushBack(T item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+
+    bool TryPopFront(T &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty())
+            return false;
+        out = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+};
+
+// Producers append at the tail while consumers drain the head.
+template <typename DequeT>
+double Run(int producers, int consumers, long long perProducer)
+{
+    DequeT deque;
+    long long total = producers * perProducer;
+    std::atomic<long long> received{0};
+    std::atomic<long long> checksum{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&] {
+            for (long long i = 0; i < perProducer; ++i)
+                deque.PushBack(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&] {
+            long long item;
+            long long sum = 0;
+            while (received.load(std::memory_order_relaxed) < total)
+            {
+                if (deque.TryPopFront(item))
+                {
+                    sum += item;
+                    received.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            checksum.fetch_add(sum);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (checksum.load() != producers * (perProducer * (perProducer - 1) / 2))
+    {
+        std::cerr << "Checksum mismatch\n";
+        std::exit(1);
+    }
+    return total / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    long long items = argc > 1 ? std::atoll(argv[1]) : 4000000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    std::cout << "threads  per-end locks(M/s)  global mutex(M/s)\n";
+    for (int threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        int producers = threads / 2;
+        int consumers = threads - producers;
+        long long perProducer = items / producers;
+
+        double split = Run<ConcurrentSegmentedDeque<long long>>(producers, consumers, perProducer);
+        double global = Run<GlobalLockDeque<long long>>(producers, consumers, perProducer);
+        std::cout << threads << "        " << split / 1e6 << "               " << global / 1e6 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "include/SpecializedADT/PriorityDeque.hpp"
+#include "include/SpecializedADT/IndexedPriorityQueue.hpp"
+
+using Distance = long long;
+using Item = std::pair<Distance, int>;
+
+struct Edge
+{
+    int to;
+    int weight;
+};
+
+struct Graph
+{
+    std::vector<int> offsets;
+    std::vector<Edge> edges;
+};
+
+static const Distance Unreachable = std::numeric_limits<Distance>::max();
+
+Graph MakeGraph(int vertices, int degree, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> vertex(0, vertices - 1);
+    std::uniform_int_distribution<int> weight(1, 1000);
+
+    Graph graph;
+    graph.offsets.resize(vertices + 1);
+    graph.edges.reserve(static_cast<size_t>(vertices) * degree);
+    for (int v = 0; v < vertices; ++v)
+    {
+        graph.offsets[v] = static_cast<int>(graph.edges.size());
+        graph.edges.push_back({(v + 1) % vertices, weight(rng)});
+        for (int e = 1; e < degree; ++e)
+        {
+            graph.edges.push_back({vertex(rng), weight(rng)});
+        }
+    }
+    graph.offsets[vertices] = static_cast<int>(graph.edges.size());
+    return graph;
+}
+
+std::vector<Distance> LazyDijkstra(const Graph &graph, int source, int &peakLength)
+{
+    int vertices = static_cast<int>(graph.offsets.size()) - 1;
+    std::vector<Distance> dist(vertices, Unreachable);
+    PriorityQueue<Item, std::greater<Item>> queue;
+
+    dist[source] = 0;
+    queue.Enqueue({0, source});
+    peakLength = 1;
+    while (!queue.IsEmpty())
+    {
+        Item top = queue.Dequeue();
+        if (top.first != dist[top.second])
+            continue;
+        for (int e = graph.offsets[top.second]; e < graph.offsets[top.second + 1]; ++e)
+        {
+            const Edge &edge = graph.edges[e];
+            Distance candidate = top.first + edge.weight;
+            if (candidate < dist[edge.to])
+            {
+                dist[edge.to] = candidate;
+                queue.Enqueue({candidate, edge.to});
+            }
+        }
+        peakLength = std::max(peakLength, queue.GetLength());
+    }
+    return dist;
+}
+
+std::vector<Distance> IndexedDijkstra(const Graph &graph, int source, int &peakLength)
+{
+    using Queue = IndexedPriorityQueue<Item, std::greater<Item>>;
+    int vertices = static_cast<int>(graph.offsets.size()) - 1;
+    std::vector<Distance> dist(vertices, Unreachable);
+    std::vector<Queue::Handle> handles(vertices);
+    Queue queue;
+
+    dist[source] = 0;
+    handles[source] = queue.Enqueue({0, source});
+    peakLength = 1;
+    while (!queue.IsEmpty())
+    {
+        Item top = queue.Dequeue();
+        for (int e = graph.offsets[top.second]; e < graph.offsets[top.second + 1]; ++e)
+        {
+            const Edge &edge = graph.edges[e];
+            Distance candidate = top.first + edge.weight;
+            if (candidate >= dist[edge.to])
+                continue;
+            if (queue.Contains(handles[edge.to]))
+                queue.UpdatePriority(handles[edge.to], {candidate, edge.to});
+            else
+                handles[edge.to] = queue.Enqueue({candidate, edge.to});
+            dist[edge.to] = candidate;
+        }
+        peakLength = std::max(peakLength, queue.GetLength());
+    }
+    return dist;
+}
+
+template <typename Run>
+double Measure(Run run)
+{
+    auto start = std::chrono::steady_clock::now();
+    run();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    int vertices = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int degree = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    Graph graph = MakeGraph(vertices, degree, 42);
+    std::cout << "Graph: " << vertices << " vertices, " << graph.edges.size() << " edges\n";
+
+    std::vector<Distance> lazy;
+    std::vector<Distance> indexed;
+    int lazyPeak = 0;
+    int indexedPeak = 0;
+
+    double lazyMs = Measure([&] { lazy = LazyDijkstra(graph, 0, lazyPeak); });
+    double indexedMs = Measure([&] { indexed = IndexedDijkstra(graph, 0, indexedPeak); });
+
+    if (lazy != indexed)
+    {
+        std::cerr << "Distance mismatch between implementations\n";
+        return 1;
+    }
+
+    std::cout << "Lazy deletion:  " << lazyMs << " ms, peak heap " << lazyPeak << "\n";
+    std::cout << "Indexed heap:   " << indexedMs << " ms, peak heap " << indexedPeak << "\n";
+    return 0;
+}
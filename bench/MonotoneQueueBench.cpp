@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "include/SpecializedADT/PriorityDeque.hpp"
+#include "include/SpecializedADT/RadixHeap.hpp"
+#include "include/SpecializedADT/BucketQueue.hpp"
+
+using Key = unsigned long long;
+using Item = std::pair<Key, int>;
+
+static const int ACTIVE_EVENTS = 100000;
+static const Key MAX_DELAY = 1000;
+
+// Discrete-event style workload: keep ACTIVE_EVENTS pending, and every
+// extracted event schedules a follow-up a random delay later.
+template <typename Pop, typename Push>
+double RunWorkload(long long operations, Pop pop, Push push, Key &checksum)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<Key> delay(1, MAX_DELAY);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ACTIVE_EVENTS; ++i)
+    {
+        push(delay(rng), i);
+    }
+    checksum = 0;
+    for (long long op = ACTIVE_EVENTS; op < operations; op += 2)
+    {
+        Item top = pop();
+        checksum += top.first;
+        push(top.first + delay(rng), top.second);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+void RunSize(long long operations)
+{
+    Key heapSum = 0;
+    Key radixSum = 0;
+    Key bucketSum = 0;
+
+    PriorityQueue<Item, std::greater<Item>> heap;
+    double heapMs = RunWorkload(
+        operations,
+        [&] { return heap.Dequeue(); },
+        [&](Key key, int value) { heap.Enqueue({key, value}); },
+        heapSum);
+
+    RadixHeap<Key, int> radix;
+    double radixMs = RunWorkload(
+        operations,
+        [&] { return radix.Dequeue(); },
+        [&](Key key, int value) { radix.Enqueue(key, value); },
+        radixSum);
+
+    BucketQueue<Key, int> buckets(MAX_DELAY + 1);
+    double bucketMs = RunWorkload(
+        operations,
+        [&] { return buckets.Dequeue(); },
+        [&](Key key, int value) { buckets.Enqueue(key, value); },
+        bucketSum);
+
+    if (heapSum != radixSum || heapSum != bucketSum)
+    {
+        std::cerr << "Checksum mismatch at " << operations << " operations\n";
+        std::exit(1);
+    }
+
+    std::cout << operations << " ops:"
+              << " PriorityQueue " << heapMs << " ms,"
+              << " RadixHeap " << radixMs << " ms,"
+              << " BucketQueue " << bucketMs << " ms\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            RunSize(std::atoll(argv[i]));
+        }
+        return 0;
+    }
+
+    RunSize(1000000);
+    RunSize(10000000);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "include/SpecializedADT/MpmcQueue.hpp"
+#include "include/SpecializedADT/Queue.hpp"
+
+static const int QUEUE_CAPACITY = 1024;
+
+// The baseline: the library's Queue<T> behind one mutex, bounded the same
+// way as MpmcQueue so both runs hold the same amount of data in flight.
+template <typename T>
+class LockedQueue
+{
+private:
+    Queue<T> queue;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    bool closed = false;
+
+public:
+    bool Enqueue(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || queue.GetLength() < QUEUE_CAPACITY; });
+        if (closed)
+            return false;
+        queue.Enqueue(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool Dequeue(T &out)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !queue.IsEmpty(); });
+        if (queue.IsEmpty())
+            return false;
+        out = queue.Dequeue();
+        notFull.notify_one();
+        return true;
+    }
+
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+template <typename QueueT>
+double Run(QueueT &queue, int producers, int consumers, long long perProducer)
+{
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(consumers, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&, c] {
+            long long item;
+            while (queue.Dequeue(item))
+                sums[c] += item;
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p)
+    {
+        senders.emplace_back([&] {
+            for (long long i = 0; i < perProducer; ++i)
+                queue.Enqueue(i);
+        });
+    }
+    for (auto &sender : senders)
+        sender.join();
+    queue.Close();
+    for (auto &thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long total = 0;
+    for (long long sum : sums)
+        total += sum;
+    if (total != producers * (perProducer * (perProducer - 1) / 2))
+    {
+        std::cerr << "Checksum mismatch\n";
+        std::exit(1);
+    }
+    return producers * perProducer / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    long long items = argc > 1 ? std::atoll(argv[1]) : 4000000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : 32;
+
+    std::cout << "threads  MpmcQueue(M/s)  mutex+Queue(M/s)\n";
+    for (int threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        int producers = threads / 2;
+        int consumers = threads - producers;
+        long long perProducer = items / producers;
+
+        MpmcQueue<long long> lockFree(QUEUE_CAPACITY);
+        double lockFreeRate = Run(lockFree, producers, consumers, perProducer);
+
+        LockedQueue<long long> locked;
+        double lockedRate = Run(locked, producers, consumers, perProducer);
+
+        std::cout << threads << "        " << lockFreeRate / 1e6 << "          " << lockedRate / 1e6 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include "include/SpecializedADT/RangeQuerySequence.hpp"
+
+// Mixed workload over a sequence of n longs: each step sets one random item
+// and reduces one random range. The baseline is what callers do today:
+// Set through operator[] and GetSubsequence(l, r)->Reduce.
+struct Sum
+{
+    long long operator()(long long a, long long b) const { return a + b; }
+    static long long Identity() { return 0; }
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct Step
+{
+    int position;
+    long long value;
+    int first;
+    int last;
+};
+
+template <typename Run>
+double Measure(const std::vector<Step> &steps, long long &checksum, Run run)
+{
+    checksum = 0;
+    auto start = Clock::now();
+    for (const Step &step : steps)
+    {
+        checksum += run(step);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / steps.size();
+}
+
+void RunSize(int size, int stepCount)
+{
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<long long> values(-1000, 1000);
+    std::uniform_int_distribution<int> positions(0, size - 1);
+    std::vector<long long> items(size);
+    for (long long &item : items)
+    {
+        item = values(rng);
+    }
+    std::vector<Step> steps(stepCount);
+    for (Step &step : steps)
+    {
+        step.position = positions(rng);
+        step.value = values(rng);
+        step.first = positions(rng);
+        step.last = positions(rng);
+        if (step.first > step.last)
+            std::swap(step.first, step.last);
+    }
+
+    ArrayMutableSequence<long long> array(items.data(), size);
+    RangeQuerySequence<long long> fenwick(items.data(), size);
+    RangeQuerySequence<long long, Sum> segment(items.data(), size);
+    RangeQuerySequence<long long, RangeMin<long long>> minimum(items.data(), size);
+
+    long long arraySum = 0;
+    long long fenwickSum = 0;
+    long long segmentSum = 0;
+    long long minimumSum = 0;
+    double arrayNs = Measure(steps, arraySum, [&](const Step &step) {
+        array[step.position] = step.value;
+        auto sub = array.GetSubsequence(step.first, step.last);
+        return static_cast<ArrayMutableSequence<long long> *>(sub.get())
+            ->Reduce([](const long long &a, const long long &b) { return a + b; }, 0);
+    });
+    double fenwickNs = Measure(steps, fenwickSum, [&](const Step &step) {
+        fenwick.Set(step.position, step.value);
+        return fenwick.RangeReduce(step.first, step.last);
+    });
+    double segmentNs = Measure(steps, segmentSum, [&](const Step &step) {
+        segment.Set(step.position, step.value);
+        return segment.RangeReduce(step.first, step.last);
+    });
+    double minimumNs = Measure(steps, minimumSum, [&](const Step &step) {
+        minimum.Set(step.position, step.value);
+        return minimum.RangeReduce(step.first, step.last);
+    });
+
+    if (arraySum != fenwickSum || arraySum != segmentSum)
+    {
+        std::cerr << "Checksum mismatch at size " << size << "\n";
+        std::exit(1);
+    }
+    std::cout << "n = " << size << ", " << stepCount << " set+reduce steps:"
+              << " GetSubsequence->Reduce " << arrayNs << " ns,"
+              << " Fenwick sum " << fenwickNs << " ns,"
+              << " segment tree sum " << segmentNs << " ns,"
+              << " segment tree min " << minimumNs << " ns (checksum " << minimumSum << ")\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            RunSize(std::atoi(argv[i]), 2000);
+        }
+        return 0;
+    }
+
+    RunSize(1000, 100000);
+    RunSize(100000, 2000);
+    RunSize(1000000, 200);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "include/SpecializedADT/SegmentLog.hpp"
+#include "include/SpecializedADT/Stream.hpp"
+
+// Sustained ingest into a BufferedStream<std::string> that spills to a
+// SegmentLog, against the in-memory stream keeping everything, then random
+// and sequential reads of the log. The log is written under the directory
+// given as the first argument (default ./segment-log-bench) and removed
+// afterwards. Reads run against a warm page cache.
+//
+// Usage: SegmentLogBench [directory] [megabytes per run]
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Anonymous resident memory, i.e. what the process holds outside the
+// mapped segment files.
+long long AnonymousKiB()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.rfind("RssAnon:", 0) == 0)
+            return std::atoll(line.c_str() + 8);
+    }
+    return -1;
+}
+
+void RunPayload(const std::string &directory, size_t payload, size_t megabytes)
+{
+    long long count = static_cast<long long>(megabytes * 1024 * 1024 / payload);
+    std::string message(payload, 'm');
+    double mb = static_cast<double>(count) * payload / (1024 * 1024);
+
+    RetentionPolicy hotTail;
+    hotTail.maxBytes = 16 * 1024 * 1024;
+    std::filesystem::remove_all(directory);
+    SegmentLog::Options options;
+    options.directory = directory;
+
+    double spilledMBps = 0;
+    double syncedMBps = 0;
+    double randomNs = 0;
+    double replayMBps = 0;
+    long long anonymous = 0;
+    int segments = 0;
+    size_t checksum = 0;
+    {
+        BufferedStream<std::string> stream(hotTail, std::make_unique<SegmentLog>(options));
+        auto start = Clock::now();
+        for (long long i = 0; i < count; ++i)
+        {
+            message[0] = static_cast<char>(i);
+            stream.Add(message);
+        }
+        spilledMBps = mb / Seconds(start);
+        stream.GetLog()->Sync();
+        syncedMBps = mb / Seconds(start);
+        anonymous = AnonymousKiB();
+
+        const SegmentLog &log = *stream.GetLog();
+        segments = log.GetSegmentCount();
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<long long> offsets(0, count - 1);
+        const int reads = 1000000;
+        start = Clock::now();
+        for (int i = 0; i < reads; ++i)
+        {
+            checksum += log.Read(offsets(rng))[0];
+        }
+        randomNs = Seconds(start) * 1e9 / reads;
+
+        start = Clock::now();
+        log.ForEach(0, count, [&](long long, std::string_view record) { checksum += record.size(); });
+        replayMBps = mb / Seconds(start);
+    }
+    std::filesystem::remove_all(directory);
+
+    double memoryMBps = 0;
+    {
+        long long inMemory = std::min<long long>(count, 512LL * 1024 * 1024 / payload);
+        BufferedStream<std::string> stream;
+        auto start = Clock::now();
+        for (long long i = 0; i < inMemory; ++i)
+        {
+            message[0] = static_cast<char>(i);
+            stream.Add(message);
+        }
+        memoryMBps = static_cast<double>(inMemory) * payload / (1024 * 1024) / Seconds(start);
+        checksum += stream.GetLength();
+    }
+
+    std::cout << payload << " B x " << count << " (" << static_cast<long long>(mb) << " MiB, "
+              << segments << " segments)\n"
+              << "  ingest, in-memory stream (<= 512 MiB): " << memoryMBps << " MB/s\n"
+              << "  ingest, spilled to segments:            " << spilledMBps << " MB/s"
+              << " (" << syncedMBps << " MB/s including msync)\n"
+              << "  anonymous RSS after ingest:             " << anonymous / 1024 << " MiB\n"
+              << "  random Read(offset):                    " << randomNs << " ns\n"
+              << "  sequential ForEach replay:              " << replayMBps << " MB/s\n"
+              << "  (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char **argv)
+{
+    std::string directory = argc > 1 ? argv[1] : "./segment-log-bench";
+    size_t megabytes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2048;
+    for (size_t payload : {256, 4096})
+    {
+        RunPayload(directory, payload, megabytes);
+    }
+}
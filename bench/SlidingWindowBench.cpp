@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "include/SpecializedADT/Deque.hpp"
+#include "include/SpecializedADT/SlidingWindow.hpp"
+
+// Rolling min/max/sum over a random stream, once with SlidingWindow and
+// once the naive way: a Deque holding the window that is rescanned after
+// every push. The rescan is O(w) per item, so it only runs while
+// items * window stays within NAIVE_BUDGET.
+static const long long NAIVE_BUDGET = 2000000000LL;
+
+struct Totals
+{
+    long long min = 0;
+    long long max = 0;
+    long long sum = 0;
+};
+
+double RunWindow(const std::vector<int> &stream, int size, Totals &totals)
+{
+    auto start = std::chrono::steady_clock::now();
+    SlidingWindow<int> window(size);
+    for (int value : stream)
+    {
+        window.Push(value);
+        totals.min += window.GetMin();
+        totals.max += window.GetMax();
+        totals.sum += window.GetSum();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+double RunNaive(const std::vector<int> &stream, int size, Totals &totals)
+{
+    auto start = std::chrono::steady_clock::now();
+    Deque<int> window;
+    RingBuffer<int> scan;
+    for (int value : stream)
+    {
+        window.PushBack(value);
+        scan.PushBack(value);
+        if (window.GetLength() > size)
+        {
+            window.PopFront();
+            scan.DropFront();
+        }
+        int low = scan[0];
+        int high = scan[0];
+        long long sum = 0;
+        for (int i = 0; i < scan.GetLength(); ++i)
+        {
+            int item = scan[i];
+            low = item < low ? item : low;
+            high = item > high ? item : high;
+            sum += item;
+        }
+        totals.min += low;
+        totals.max += high;
+        totals.sum += sum;
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> values(-1000000, 1000000);
+    std::vector<int> stream(count);
+    for (int &value : stream)
+    {
+        value = values(rng);
+    }
+
+    for (int size = 10; size <= 1000000; size *= 10)
+    {
+        Totals fast;
+        double fastMs = RunWindow(stream, size, fast);
+        std::cout << "window " << size << ": SlidingWindow " << fastMs << " ms ("
+                  << fastMs * 1e6 / count << " ns/item)";
+
+        if (static_cast<long long>(count) * size <= NAIVE_BUDGET)
+        {
+            Totals naive;
+            double naiveMs = RunNaive(stream, size, naive);
+            if (naive.min != fast.min || naive.max != fast.max || naive.sum != fast.sum)
+            {
+                std::cerr << "\nChecksum mismatch at window " << size << "\n";
+                return 1;
+            }
+            std::cout << ", Deque rescan " << naiveMs << " ms ("
+                      << naiveMs * 1e6 / count << " ns/item)";
+        }
+        else
+        {
+            std::cout << ", Deque rescan skipped";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "include/SpecializedADT/SpscRingQueue.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int QUEUE_CAPACITY = 4096;
+static const int BATCH_SIZE = 64;
+
+double Throughput(long long count, bool batched)
+{
+    SpscRingQueue<std::uint64_t> queue(QUEUE_CAPACITY);
+    std::uint64_t checksum = 0;
+
+    auto start = Clock::now();
+    std::thread consumer([&] {
+        std::uint64_t batch[BATCH_SIZE];
+        long long received = 0;
+        while (received < count)
+        {
+            if (batched)
+            {
+                int popped = queue.TryPopN(batch, BATCH_SIZE);
+                for (int i = 0; i < popped; ++i)
+                    checksum += batch[i];
+                received += popped;
+                if (popped == 0)
+                    std::this_thread::yield();
+            }
+            else
+            {
+                std::uint64_t item;
+                if (queue.TryPop(item))
+                {
+                    checksum += item;
+                    ++received;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    std::uint64_t batch[BATCH_SIZE];
+    long long sent = 0;
+    while (sent < count)
+    {
+        if (batched)
+        {
+            int wanted = static_cast<int>(std::min<long long>(BATCH_SIZE, count - sent));
+            for (int i = 0; i < wanted; ++i)
+                batch[i] = sent + i;
+            int pushed = queue.TryPushN(batch, wanted);
+            sent += pushed;
+            if (pushed == 0)
+                std::this_thread::yield();
+        }
+        else if (queue.TryPush(sent))
+        {
+            ++sent;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::uint64_t expected = static_cast<std::uint64_t>(count) * (count - 1) / 2;
+    if (checksum != expected)
+    {
+        std::cerr << "Checksum mismatch\n";
+        std::exit(1);
+    }
+    return count / seconds;
+}
+
+// Ping-pong between two queues; half the round trip is the one-way latency.
+// Spinning threads yield so the numbers stay meaningful when there are
+// fewer cores than threads.
+void Latency(int rounds)
+{
+    SpscRingQueue<Clock::time_point> ping(QUEUE_CAPACITY);
+    SpscRingQueue<Clock::time_point> pong(QUEUE_CAPACITY);
+
+    std::thread echo([&] {
+        for (int i = 0; i < rounds; ++i)
+        {
+            Clock::time_point stamp;
+            while (!ping.TryPop(stamp))
+            {
+                std::this_thread::yield();
+            }
+            while (!pong.TryPush(stamp))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(rounds);
+    for (int i = 0; i < rounds; ++i)
+    {
+        while (!ping.TryPush(Clock::now()))
+        {
+        }
+        Clock::time_point stamp;
+        while (!pong.TryPop(stamp))
+        {
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - stamp).count() / 2);
+    }
+    echo.join();
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << "One-way latency: p50 " << samples[samples.size() / 2] << " ns,"
+              << " p99 " << samples[samples.size() * 99 / 100] << " ns,"
+              << " p999 " << samples[samples.size() * 999 / 1000] << " ns\n";
+}
+
+int main(int argc, char **argv)
+{
+    long long count = argc > 1 ? std::atoll(argv[1]) : 50000000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    std::cout << "Single push/pop: " << Throughput(count, false) / 1e6 << " M items/s\n";
+    std::cout << "Batches of " << BATCH_SIZE << ":    " << Throughput(count, true) / 1e6 << " M items/s\n";
+    Latency(rounds);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "include/SpecializedADT/Stream.hpp"
+
+// Cost per message of getting a frame from the receive ring into a
+// BufferedStream<std::string> and reading it back once, the way the server
+// does. Frames arrive as string_views; retention keeps the newest 64k so
+// the stream is in steady state. "copying" is the old path: the frame is
+// turned into a string, copied into the current slot, committed, and read
+// back with Get.
+using Clock = std::chrono::steady_clock;
+
+const int MESSAGES = 1000000;
+const int BATCH = 64;
+
+template <typename Run>
+void Measure(const char *name, size_t payload, Run run)
+{
+    std::string frame(payload, 'f');
+    RetentionPolicy retention;
+    retention.maxCount = 1 << 16;
+    BufferedStream<std::string> stream(retention);
+    auto consumer = stream.Subscribe("bench");
+    size_t checksum = 0;
+
+    auto start = Clock::now();
+    run(stream, consumer, std::string_view(frame), checksum);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / MESSAGES;
+    std::cout << "  " << name << ": " << ns << " ns/msg (" << 1000 / ns << " M msg/s, checksum "
+              << checksum << ")\n";
+}
+
+void Drain(BufferedStream<std::string>::Consumer &consumer, size_t &checksum)
+{
+    auto batch = consumer.Poll(BATCH);
+    for (int i = 0; i < batch.GetLength(); ++i)
+    {
+        checksum += batch[i].size();
+    }
+}
+
+int main()
+{
+    using Stream = BufferedStream<std::string>;
+    using Consumer = Stream::Consumer;
+    for (size_t payload : {64, 512})
+    {
+        std::cout << payload << " B messages\n";
+        Measure("copying SetCurrent + Get    ", payload,
+                [](Stream &stream, Consumer &, std::string_view frame, size_t &checksum)
+                {
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        std::string message(frame);
+                        stream.SetCurrent(static_cast<const std::string &>(message));
+                        stream.CommitCurrentToBuffer();
+                        checksum += stream.Get(stream.GetLength() - 1).size();
+                    }
+                });
+        Measure("SetCurrent(T&&) + Poll      ", payload,
+                [](Stream &stream, Consumer &consumer, std::string_view frame, size_t &checksum)
+                {
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        stream.SetCurrent(std::string(frame));
+                        stream.CommitCurrentToBuffer();
+                        if (i % BATCH == BATCH - 1)
+                            Drain(consumer, checksum);
+                    }
+                });
+        Measure("Emplace + Poll              ", payload,
+                [](Stream &stream, Consumer &consumer, std::string_view frame, size_t &checksum)
+                {
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        stream.Emplace(frame);
+                        if (i % BATCH == BATCH - 1)
+                            Drain(consumer, checksum);
+                    }
+                });
+        Measure("CommitBatch(64) + Poll      ", payload,
+                [](Stream &stream, Consumer &consumer, std::string_view frame, size_t &checksum)
+                {
+                    std::vector<std::string> batch;
+                    batch.reserve(BATCH);
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        batch.emplace_back(frame);
+                        if (batch.size() == BATCH)
+                        {
+                            stream.CommitBatch(std::make_move_iterator(batch.begin()),
+                                               std::make_move_iterator(batch.end()));
+                            batch.clear();
+                            Drain(consumer, checksum);
+                        }
+                    }
+                });
+        Measure("group commit 64 + Poll      ", payload,
+                [](Stream &stream, Consumer &consumer, std::string_view frame, size_t &checksum)
+                {
+                    stream.SetGroupCommit(BATCH);
+                    for (int i = 0; i < MESSAGES; ++i)
+                    {
+                        stream.Emplace(frame);
+                        if (i % BATCH == BATCH - 1)
+                            Drain(consumer, checksum);
+                    }
+                });
+    }
+}
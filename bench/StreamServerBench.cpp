@@ -0,0 +1,140 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "include/Network/Framing.hpp"
+#include "include/Network/StreamServer.hpp"
+
+// Loopback load test: `connections` clients stay connected at once and
+// `senders` threads send `rounds` length-prefixed messages of `size` bytes
+// on each of them, round-robin. Reports how long the server takes to
+// deliver every frame, and how many receive-path system calls (epoll_wait
+// or io_uring_enter, plus readv) it made per message.
+// Usage: StreamServerBench [connections] [loops] [rounds] [size] [senders] [epoll|uring]
+
+using Clock = std::chrono::steady_clock;
+
+int Connect(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        std::exit(1);
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+void SendAll(int fd, const std::string &message)
+{
+    size_t offset = 0;
+    while (offset < message.size())
+    {
+        ssize_t count = send(fd, message.data() + offset, message.size() - offset, 0);
+        if (count < 0)
+        {
+            perror("send");
+            std::exit(1);
+        }
+        offset += count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int connections = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int loops = argc > 2 ? std::atoi(argv[2]) : 1;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 200;
+    int size = argc > 4 ? std::atoi(argv[4]) : 64;
+    int senders = argc > 5 ? std::atoi(argv[5]) : 4;
+    bool uring = argc > 6 && std::string(argv[6]) == "uring";
+
+    std::atomic<long long> handled{0};
+    StreamServer::Options options;
+    options.port = 0;
+    options.loops = loops;
+    options.backend = uring ? ReceiveBackend::IoUring : ReceiveBackend::Epoll;
+    StreamServer server(
+        [&](int, std::string_view message) { handled.fetch_add(message.size(), std::memory_order_relaxed); },
+        options);
+    server.Start();
+
+    auto start = Clock::now();
+    std::vector<int> clients(connections);
+    for (int &fd : clients)
+    {
+        fd = Connect(server.GetPort());
+    }
+    while (server.GetStats().accepted < connections)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double connectMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::string message;
+    AppendFrame(message, std::string(size, 'x'));
+    long long sends = static_cast<long long>(connections) * rounds;
+    long long expected = sends * size;
+    start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < senders; ++t)
+    {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < rounds; ++round)
+            {
+                for (int i = t; i < connections; i += senders)
+                {
+                    SendAll(clients[i], message);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    while (handled.load(std::memory_order_relaxed) < expected)
+    {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    StreamServer::Stats stats = server.GetStats();
+    if (stats.messages != sends)
+    {
+        std::cerr << "Expected " << sends << " frames, got " << stats.messages << "\n";
+        return 1;
+    }
+    std::cout << (server.GetBackend() == ReceiveBackend::IoUring ? "io_uring" : "epoll") << ", "
+              << connections << " connections, " << loops << " loop(s), " << senders << " sender threads, "
+              << sends << " sends of " << size << " B\n"
+              << "  connect + accept: " << connectMs << " ms\n"
+              << "  ingest: " << seconds * 1e3 << " ms, " << expected / seconds / 1e6 << " MB/s, "
+              << sends / seconds / 1e3 << " k msgs/s, " << stats.reads << " server reads ("
+              << static_cast<double>(stats.messages) / stats.reads << " msgs per read)\n"
+              << "  syscalls: " << stats.waits << " waits + " << stats.receiveCalls << " readv = "
+              << static_cast<double>(stats.waits + stats.receiveCalls) / stats.messages << " per message\n";
+
+    for (int fd : clients)
+    {
+        close(fd);
+    }
+    return 0;
+}
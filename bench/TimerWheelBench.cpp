@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "include/SpecializedADT/TimerWheel.hpp"
+#include "include/SpecializedADT/IndexedPriorityQueue.hpp"
+#include "include/SpecializedADT/PriorityDeque.hpp"
+
+// Connection-timeout workload: `timers` connections with a one-minute idle
+// timeout (one tick = 1 ms), initially spread over the minute. Every
+// simulated tick, TOUCHES_PER_TICK random connections see activity and
+// push their timeout back to a full minute, then the clock advances one
+// tick and each expired timer is rearmed.
+static const unsigned long long IDLE_TIMEOUT = 60000;
+static const int TOUCHES_PER_TICK = 1000;
+
+using Clock = std::chrono::steady_clock;
+using Timeout = std::pair<unsigned long long, int>;
+
+struct Result
+{
+    double scheduleMs = 0;
+    double runMs = 0;
+    long long fired = 0;
+    int entries = 0;
+};
+
+double Since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Result RunWheel(int timers, int ticks)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<unsigned long long> delay(1, IDLE_TIMEOUT);
+    std::uniform_int_distribution<int> pick(0, timers - 1);
+    Result result;
+
+    TimerWheel<int> wheel;
+    std::vector<TimerWheel<int>::Handle> handles(timers);
+    auto start = Clock::now();
+    for (int id = 0; id < timers; ++id)
+    {
+        handles[id] = wheel.Schedule(delay(rng), id);
+    }
+    result.scheduleMs = Since(start);
+
+    start = Clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        for (int i = 0; i < TOUCHES_PER_TICK; ++i)
+        {
+            wheel.Reschedule(handles[pick(rng)], IDLE_TIMEOUT);
+        }
+        result.fired += wheel.Advance(1, [&](int id) { handles[id] = wheel.Schedule(IDLE_TIMEOUT, id); });
+    }
+    result.runMs = Since(start);
+    result.entries = wheel.GetLength();
+    return result;
+}
+
+Result RunIndexedHeap(int timers, int ticks)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<unsigned long long> delay(1, IDLE_TIMEOUT);
+    std::uniform_int_distribution<int> pick(0, timers - 1);
+    Result result;
+
+    IndexedPriorityQueue<Timeout, std::greater<Timeout>> heap;
+    std::vector<IndexedPriorityQueue<Timeout, std::greater<Timeout>>::Handle> handles(timers);
+    unsigned long long now = 0;
+    auto start = Clock::now();
+    heap.Reserve(timers);
+    for (int id = 0; id < timers; ++id)
+    {
+        handles[id] = heap.Enqueue({now + delay(rng), id});
+    }
+    result.scheduleMs = Since(start);
+
+    start = Clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        for (int i = 0; i < TOUCHES_PER_TICK; ++i)
+        {
+            int id = pick(rng);
+            heap.UpdatePriority(handles[id], {now + IDLE_TIMEOUT, id});
+        }
+        ++now;
+        while (!heap.IsEmpty() && heap.Peek().first <= now)
+        {
+            int id = heap.Dequeue().second;
+            handles[id] = heap.Enqueue({now + IDLE_TIMEOUT, id});
+            ++result.fired;
+        }
+    }
+    result.runMs = Since(start);
+    result.entries = heap.GetLength();
+    return result;
+}
+
+// The usual heap shortcut: a touch pushes a fresh entry and stale entries
+// are skipped on the way out by comparing against the latest deadline.
+Result RunLazyHeap(int timers, int ticks)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<unsigned long long> delay(1, IDLE_TIMEOUT);
+    std::uniform_int_distribution<int> pick(0, timers - 1);
+    Result result;
+
+    PriorityQueue<Timeout, std::greater<Timeout>> heap;
+    std::vector<unsigned long long> deadlines(timers);
+    unsigned long long now = 0;
+    auto start = Clock::now();
+    for (int id = 0; id < timers; ++id)
+    {
+        deadlines[id] = now + delay(rng);
+        heap.Enqueue({deadlines[id], id});
+    }
+    result.scheduleMs = Since(start);
+
+    start = Clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        for (int i = 0; i < TOUCHES_PER_TICK; ++i)
+        {
+            int id = pick(rng);
+            deadlines[id] = now + IDLE_TIMEOUT;
+            heap.Enqueue({deadlines[id], id});
+        }
+        ++now;
+        while (!heap.IsEmpty() && heap.Peek().first <= now)
+        {
+            Timeout top = heap.Dequeue();
+            if (deadlines[top.second] != top.first)
+                continue;
+            deadlines[top.second] = now + IDLE_TIMEOUT;
+            heap.Enqueue({deadlines[top.second], top.second});
+            ++result.fired;
+        }
+    }
+    result.runMs = Since(start);
+    result.entries = heap.GetLength();
+    return result;
+}
+
+void Report(const char *name, const Result &result, int timers, int ticks)
+{
+    long long operations = static_cast<long long>(ticks) * TOUCHES_PER_TICK + result.fired;
+    std::cout << "  " << name << ": schedule " << result.scheduleMs * 1e6 / timers << " ns/timer, "
+              << "steady state " << result.runMs << " ms (" << result.runMs * 1e6 / operations
+              << " ns per touch or expiry, " << result.fired << " fired, "
+              << result.entries << " entries held)\n";
+}
+
+int main(int argc, char **argv)
+{
+    int timers = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 5000;
+
+    std::cout << timers << " active timers, " << ticks << " ticks, " << TOUCHES_PER_TICK
+              << " touches per tick:\n";
+    Report("TimerWheel", RunWheel(timers, ticks), timers, ticks);
+    Report("IndexedPriorityQueue", RunIndexedHeap(timers, ticks), timers, ticks);
+    Report("PriorityQueue + lazy cancel", RunLazyHeap(timers, ticks), timers, ticks);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "include/SpecializedADT/WorkStealingDeque.hpp"
+
+static const int SEQUENTIAL_CUTOFF = 20;
+
+long long Fib(int n)
+{
+    return n < 2 ? n : Fib(n - 1) + Fib(n - 2);
+}
+
+// Parallel fib without joins: a task for n above the cutoff splits into
+// tasks for n-1 and n-2, a task below it adds Fib(n) to the result. The
+// sum of all leaves is Fib of the root.
+long long ParallelFib(int n, int workers)
+{
+    std::vector<std::unique_ptr<WorkStealingDeque<int>>> deques;
+    for (int i = 0; i < workers; ++i)
+        deques.push_back(std::make_unique<WorkStealingDeque<int>>());
+
+    std::atomic<long long> result{0};
+    std::atomic<long long> pending{1};
+    deques[0]->PushBottom(n);
+
+    auto work = [&](int self) {
+        std::mt19937 rng(self);
+        WorkStealingDeque<int> &own = *deques[self];
+        while (pending.load(std::memory_order_acquire) > 0)
+        {
+            int task;
+            bool found = own.PopBottom(task);
+            if (!found && workers > 1)
+            {
+                int victim = static_cast<int>(rng() % workers);
+                found = victim != self && deques[victim]->Steal(task);
+            }
+            if (!found)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (task <= SEQUENTIAL_CUTOFF)
+            {
+                result.fetch_add(Fib(task), std::memory_order_relaxed);
+            }
+            else
+            {
+                pending.fetch_add(2, std::memory_order_relaxed);
+                own.PushBottom(task - 2);
+                own.PushBottom(task - 1);
+            }
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; ++i)
+        threads.emplace_back(work, i);
+    work(0);
+    for (auto &thread : threads)
+        thread.join();
+    return result.load();
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 36;
+    int maxWorkers = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (maxWorkers < 1)
+        maxWorkers = 1;
+
+    long long expected = Fib(n);
+    double baseline = 0;
+    std::cout << "fib(" << n << ") = " << expected << "\n";
+    for (int workers = 1; workers <= maxWorkers; workers *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        long long value = ParallelFib(n, workers);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (value != expected)
+        {
+            std::cerr << "Wrong result with " << workers << " workers\n";
+            return 1;
+        }
+        if (workers == 1)
+            baseline = ms;
+        std::cout << workers << " workers: " << ms << " ms, speedup " << baseline / ms << "x\n";
+    }
+    return 0;
+}
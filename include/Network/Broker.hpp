@@ -0,0 +1,731 @@
+#pragma once
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "include/Network/Framing.hpp"
+#include "include/Network/StreamServer.hpp"
+#include "include/SpecializedADT/SegmentLog.hpp"
+#include "include/SpecializedADT/Stream.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Publish/subscribe over StreamServer. Every topic is a BufferedStream with
+// its own retention, created by the first message published to it. A
+// connection that sends a Subscribe frame is pushed every message of that
+// topic as a Deliver frame. One dispatcher thread serves all subscribers:
+// it polls each subscription's cursor for a batch and hands the batch to
+// sendmsg as header/body pairs, so bodies go from the stream, or from the
+// mapped segments of a spilled topic for subscribers that start behind its
+// hot tail, to the socket without being copied. Writes pass MSG_NOSIGNAL,
+// so a subscriber that resets its connection does not raise SIGPIPE in the
+// host process. A frame the socket did not take in full is resumed
+// when epoll reports the socket writable again; a subscriber whose partly
+// written message is evicted before it can be finished is disconnected.
+//
+// With a high watermark set, a publisher that leaves a topic's slowest
+// subscriber more than that many messages behind has its connection paused
+// (see StreamServer::PauseReading); it resumes once the backlog drains to
+// the low watermark. TCP then slows the publisher down instead of the topic
+// evicting what subscribers have not read yet.
+//
+// Acks for publishes that ask for one are queued by the loop thread and
+// written by the dispatcher too, between whole Deliver frames, so that a
+// connection which both publishes and subscribes gets an intact stream.
+class Broker
+{
+public:
+    using Stream = BufferedStream<std::string>;
+
+    struct Options
+    {
+        StreamServer::Options server;
+        // Retention of topics created by their first message.
+        RetentionPolicy retention;
+        // When set, each topic spills to a SegmentLog in a subdirectory
+        // named after the topic.
+        std::string spillDirectory;
+        size_t segmentBytes = 64 * 1024 * 1024;
+        int groupCommit = 1;
+        int maxTopics = 1024;
+        // Messages per sendmsg; each takes two iovecs.
+        int deliveryBatch = 256;
+        // Where newline-delimited frames, which carry no topic, are published.
+        std::string defaultTopic = "default";
+        // Backlog, in messages behind a topic's slowest subscriber, that
+        // pauses its publishers; zero turns flow control off. The low
+        // watermark defaults to half the high one.
+        int highWatermark = 0;
+        int lowWatermark = 0;
+        // A connection with more unsent ack bytes than this is dropped.
+        size_t maxPendingAcks = 16 * 1024 * 1024;
+    };
+
+    struct Stats
+    {
+        long long published = 0;
+        long long rejected = 0;
+        long long subscribed = 0;
+        long long delivered = 0;
+        long long deliveredBytes = 0;
+        long long writes = 0;
+        long long dropped = 0;
+        long long throttled = 0;
+        long long acknowledged = 0;
+    };
+
+private:
+    struct Topic
+    {
+        std::mutex writeMutex;
+        Stream stream;
+        // Lowest position among the topic's subscribers, published by the
+        // dispatcher; LLONG_MAX when it has none.
+        std::atomic<long long> floor{LLONG_MAX};
+        // Publishers paused on this topic; guarded by writeMutex.
+        std::vector<int> paused;
+
+        explicit Topic(const RetentionPolicy &retention) : stream(retention) {}
+
+        Topic(const RetentionPolicy &retention, std::unique_ptr<SegmentLog> log)
+            : stream(retention, std::move(log)) {}
+    };
+
+    struct Subscription
+    {
+        std::string name;
+        Topic *topic;
+        Stream::Consumer consumer;
+    };
+
+    struct Subscriber
+    {
+        std::vector<Subscription> subscriptions;
+        // Subscription with a partly written frame, and how much of that
+        // frame the socket has taken.
+        int active = 0;
+        size_t sentBytes = 0;
+        // Ack frames for the connection and how many bytes of them the
+        // socket has taken.
+        std::string acks;
+        size_t ackSent = 0;
+    };
+
+    enum class Pumped
+    {
+        Idle,
+        Progress,
+        Blocked,
+        Failed
+    };
+
+    Options options;
+    StreamServer server;
+
+    mutable std::shared_mutex topicsMutex;
+    std::map<std::string, std::unique_ptr<Topic>, std::less<>> topics;
+
+    std::mutex subscribersMutex;
+    std::map<int, std::unique_ptr<Subscriber>> subscribers;
+
+    // Acks queued by the loops, moved to their Subscriber by the dispatcher.
+    // Taken after subscribersMutex when both are needed.
+    std::mutex acksMutex;
+    std::map<int, std::string> pendingAcks;
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> wakePending{false};
+    std::atomic<bool> stopping{false};
+    std::thread dispatcher;
+
+    // Dispatcher scratch, reused for every sendmsg.
+    std::vector<char> headers;
+    std::vector<iovec> spans;
+    std::vector<size_t> frameSizes;
+    std::map<Topic *, long long> floors;
+
+    std::atomic<long long> published{0};
+    std::atomic<long long> rejected{0};
+    std::atomic<long long> subscribed{0};
+    std::atomic<long long> delivered{0};
+    std::atomic<long long> deliveredBytes{0};
+    std::atomic<long long> writes{0};
+    std::atomic<long long> dropped{0};
+    std::atomic<long long> throttled{0};
+    std::atomic<long long> acknowledged{0};
+
+    static bool IsValidTopic(std::string_view name)
+    {
+        if (name.empty() || name.size() > MAX_TOPIC_LENGTH || name == "." || name == "..")
+            return false;
+        return std::all_of(name.begin(), name.end(), [](char c)
+                           { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                                    (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-'; });
+    }
+
+    std::unique_ptr<Topic> MakeTopic(const std::string &name, const RetentionPolicy &retention) const
+    {
+        std::unique_ptr<Topic> topic;
+        if (options.spillDirectory.empty())
+        {
+            topic = std::make_unique<Topic>(retention);
+        }
+        else
+        {
+            SegmentLog::Options spill;
+            spill.directory = options.spillDirectory + "/" + name;
+            spill.segmentBytes = options.segmentBytes;
+            topic = std::make_unique<Topic>(retention, std::make_unique<SegmentLog>(spill));
+        }
+        topic->stream.SetGroupCommit(options.groupCommit);
+        return topic;
+    }
+
+    // The topic called `name`, created on first use; nullptr if the name is
+    // invalid or the topic limit has been reached.
+    Topic *FindOrCreate(std::string_view name)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(topicsMutex);
+            auto found = topics.find(name);
+            if (found != topics.end())
+                return found->second.get();
+        }
+        if (!IsValidTopic(name))
+            return nullptr;
+        std::unique_lock<std::shared_mutex> lock(topicsMutex);
+        auto found = topics.find(name);
+        if (found != topics.end())
+            return found->second.get();
+        if (static_cast<int>(topics.size()) >= options.maxTopics)
+            return nullptr;
+        std::string key(name);
+        return (topics[key] = MakeTopic(key, options.retention)).get();
+    }
+
+    void Wake()
+    {
+        if (wakePending.exchange(true))
+            return;
+        unsigned long long one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0)
+            throw std::system_error(errno, std::generic_category(), "eventfd write");
+    }
+
+    void OnFrame(int connection, std::string_view payload)
+    {
+        if (options.server.framing == FramingMode::NewlineDelimited)
+        {
+            PublishFrom(connection, options.defaultTopic, payload);
+            return;
+        }
+        TopicFrame frame;
+        if (!ParseTopicFrame(payload, frame) || frame.kind == FrameKind::Deliver || frame.kind == FrameKind::Ack)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (frame.kind == FrameKind::Subscribe)
+        {
+            Subscribe(connection, frame.topic, frame.offset);
+            return;
+        }
+        long long offset = PublishFrom(connection, frame.topic, frame.body);
+        if (frame.offset >= 0)
+            Acknowledge(connection, frame.topic, offset, static_cast<uint64_t>(frame.offset));
+    }
+
+    // Queues an Ack echoing `tag` for the dispatcher to write.
+    void Acknowledge(int connection, std::string_view topic, long long offset, uint64_t tag)
+    {
+        char body[MAX_VARINT_BYTES];
+        int length = EncodeVarint(tag, body);
+        {
+            std::lock_guard<std::mutex> lock(acksMutex);
+            AppendTopicFrame(pendingAcks[connection], FrameKind::Ack, topic, std::string_view(body, length), offset);
+        }
+        acknowledged.fetch_add(1, std::memory_order_relaxed);
+        Wake();
+    }
+
+    // `connection` is paused if this message takes the topic past the high
+    // watermark; -1 publishes without flow control.
+    long long PublishFrom(int connection, std::string_view topic, std::string_view body)
+    {
+        Topic *target = FindOrCreate(topic);
+        if (!target)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        long long offset;
+        bool pause = false;
+        {
+            std::lock_guard<std::mutex> lock(target->writeMutex);
+            offset = target->stream.Emplace(body);
+            if (connection >= 0 && options.highWatermark > 0 &&
+                offset + 1 - target->floor.load() >= options.highWatermark)
+            {
+                if (std::find(target->paused.begin(), target->paused.end(), connection) == target->paused.end())
+                    target->paused.push_back(connection);
+                pause = true;
+            }
+        }
+        published.fetch_add(1, std::memory_order_relaxed);
+        if (pause)
+        {
+            server.PauseReading(connection);
+            throttled.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Also after a pause, so that the dispatcher re-checks the backlog
+        // even if the subscribers have already caught up.
+        Wake();
+        return offset;
+    }
+
+    void Subscribe(int connection, std::string_view name, long long offset)
+    {
+        Topic *topic = FindOrCreate(name);
+        if (!topic)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Stream::Consumer consumer = topic->stream.Subscribe("connection-" + std::to_string(connection));
+        if (offset < 0)
+        {
+            std::lock_guard<std::mutex> lock(topic->writeMutex);
+            offset = topic->stream.GetNextOffset() + topic->stream.GetStagedCount();
+        }
+        consumer.Seek(offset);
+
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        Subscriber *subscriber = Register(connection);
+        auto existing = std::find_if(subscriber->subscriptions.begin(), subscriber->subscriptions.end(),
+                                     [&](const Subscription &item) { return item.topic == topic; });
+        if (existing == subscriber->subscriptions.end())
+            subscriber->subscriptions.push_back({std::string(name), topic, consumer});
+        else if (subscriber->sentBytes == 0 || existing - subscriber->subscriptions.begin() != subscriber->active)
+            existing->consumer = consumer;
+        subscribed.fetch_add(1, std::memory_order_relaxed);
+        Wake();
+    }
+
+    // The Subscriber for `connection`, created and watched for writability
+    // on first use. Caller holds subscribersMutex.
+    Subscriber *Register(int connection)
+    {
+        std::unique_ptr<Subscriber> &subscriber = subscribers[connection];
+        if (!subscriber)
+        {
+            subscriber = std::make_unique<Subscriber>();
+            epoll_event event{};
+            event.events = EPOLLOUT | EPOLLET;
+            event.data.fd = connection;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, connection, &event) < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+        }
+        return subscriber.get();
+    }
+
+    // Runs on the loop thread before the server closes the socket. Pause
+    // sets hold descriptors, so the connection must leave them before a new
+    // one can take its number.
+    void OnClose(int connection)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(topicsMutex);
+            for (auto &entry : topics)
+            {
+                Topic &topic = *entry.second;
+                std::lock_guard<std::mutex> write(topic.writeMutex);
+                topic.paused.erase(std::remove(topic.paused.begin(), topic.paused.end(), connection),
+                                   topic.paused.end());
+            }
+        }
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        {
+            std::lock_guard<std::mutex> acksLock(acksMutex);
+            pendingAcks.erase(connection);
+        }
+        auto found = subscribers.find(connection);
+        if (found == subscribers.end())
+            return;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection, nullptr);
+        subscribers.erase(found);
+    }
+
+    // One sendmsg of the next batch of `subscription` to `fd`.
+    Pumped PumpOne(int fd, Subscriber &subscriber, Subscription &subscription)
+    {
+        long long expected = subscription.consumer.GetPosition();
+        auto batch = subscription.consumer.Poll(options.deliveryBatch);
+        if (batch.IsEmpty())
+            return Pumped::Idle;
+        long long first = batch.GetFirstOffset();
+        if (subscriber.sentBytes > 0 && first != expected)
+            return Pumped::Failed;
+
+        int count = batch.GetLength();
+        spans.clear();
+        frameSizes.clear();
+        size_t skip = subscriber.sentBytes;
+        for (int i = 0; i < count; ++i)
+        {
+            std::string_view body = batch.View(i);
+            char *header = headers.data() + static_cast<size_t>(i) * MAX_TOPIC_HEADER_BYTES;
+            size_t headerSize = EncodeTopicHeader(header, FrameKind::Deliver, subscription.name,
+                                                  first + i, body.size());
+            frameSizes.push_back(headerSize + body.size());
+            iovec parts[2] = {{header, headerSize}, {const_cast<char *>(body.data()), body.size()}};
+            for (iovec part : parts)
+            {
+                size_t skipped = std::min(skip, part.iov_len);
+                skip -= skipped;
+                if (part.iov_len > skipped)
+                    spans.push_back({static_cast<char *>(part.iov_base) + skipped, part.iov_len - skipped});
+            }
+        }
+
+        msghdr message{};
+        message.msg_iov = spans.data();
+        message.msg_iovlen = spans.size();
+        ssize_t written;
+        do
+        {
+            written = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+        } while (written < 0 && errno == EINTR);
+        if (written < 0)
+        {
+            subscription.consumer.Seek(first);
+            return errno == EAGAIN || errno == EWOULDBLOCK ? Pumped::Blocked : Pumped::Failed;
+        }
+        writes.fetch_add(1, std::memory_order_relaxed);
+        deliveredBytes.fetch_add(written, std::memory_order_relaxed);
+
+        size_t progress = subscriber.sentBytes + static_cast<size_t>(written);
+        int done = 0;
+        while (done < count && progress >= frameSizes[done])
+        {
+            progress -= frameSizes[done++];
+        }
+        subscriber.sentBytes = progress;
+        subscription.consumer.Seek(first + done);
+        subscription.consumer.Commit();
+        delivered.fetch_add(done, std::memory_order_relaxed);
+        return done == count ? Pumped::Progress : Pumped::Blocked;
+    }
+
+    // Writes the connection's queued acks.
+    Pumped PumpAcks(int fd, Subscriber &subscriber)
+    {
+        if (subscriber.acks.empty())
+            return Pumped::Idle;
+        if (subscriber.acks.size() - subscriber.ackSent > options.maxPendingAcks)
+            return Pumped::Failed;
+        ssize_t written;
+        do
+        {
+            written = ::send(fd, subscriber.acks.data() + subscriber.ackSent,
+                             subscriber.acks.size() - subscriber.ackSent, MSG_NOSIGNAL);
+        } while (written < 0 && errno == EINTR);
+        if (written < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK ? Pumped::Blocked : Pumped::Failed;
+        writes.fetch_add(1, std::memory_order_relaxed);
+        subscriber.ackSent += static_cast<size_t>(written);
+        if (subscriber.ackSent < subscriber.acks.size())
+            return Pumped::Blocked;
+        subscriber.acks.clear();
+        subscriber.ackSent = 0;
+        return Pumped::Progress;
+    }
+
+    // Queued acks, unless a Deliver frame is half written, then one batch
+    // for every subscription of `fd`, starting with the one that has a
+    // partly written frame.
+    Pumped Pump(int fd, Subscriber &subscriber)
+    {
+        Pumped result = Pumped::Idle;
+        if (subscriber.sentBytes == 0)
+        {
+            result = PumpAcks(fd, subscriber);
+            if (result == Pumped::Blocked || result == Pumped::Failed)
+                return result;
+        }
+        int count = static_cast<int>(subscriber.subscriptions.size());
+        for (int n = 0; n < count; ++n)
+        {
+            int index = (subscriber.active + n) % count;
+            Pumped pumped = PumpOne(fd, subscriber, subscriber.subscriptions[index]);
+            if (pumped == Pumped::Blocked || pumped == Pumped::Failed)
+            {
+                subscriber.active = index;
+                return pumped;
+            }
+            if (pumped == Pumped::Progress)
+                result = Pumped::Progress;
+        }
+        return result;
+    }
+
+    // One pass over every subscriber; true if any of them may have more.
+    // Leaves the lowest subscriber position of each topic in `floors`.
+    bool PumpAll()
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        bool more = false;
+        floors.clear();
+        std::map<int, std::string> acks;
+        {
+            std::lock_guard<std::mutex> acksLock(acksMutex);
+            acks.swap(pendingAcks);
+        }
+        for (auto &entry : acks)
+        {
+            Subscriber *subscriber = Register(entry.first);
+            if (subscriber->acks.empty())
+                subscriber->acks.swap(entry.second);
+            else
+                subscriber->acks += entry.second;
+        }
+        for (auto it = subscribers.begin(); it != subscribers.end();)
+        {
+            Pumped pumped = Pump(it->first, *it->second);
+            if (pumped == Pumped::Failed)
+            {
+                // The server notices the shutdown and closes the socket.
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, it->first, nullptr);
+                ::shutdown(it->first, SHUT_RDWR);
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                it = subscribers.erase(it);
+                continue;
+            }
+            more = more || pumped == Pumped::Progress;
+            for (const Subscription &subscription : it->second->subscriptions)
+            {
+                auto floor = floors.emplace(subscription.topic, LLONG_MAX).first;
+                floor->second = std::min(floor->second, subscription.consumer.GetPosition());
+            }
+            ++it;
+        }
+        return more;
+    }
+
+    // Publishes the floors from the last pass and resumes the publishers of
+    // every topic whose backlog is down to the low watermark. The resumes
+    // are queued under the topic's lock, so OnClose either finds the
+    // connection still paused or runs after the resume is queued, where
+    // the server drops it.
+    void ResumeDrained()
+    {
+        int low = options.lowWatermark > 0 ? options.lowWatermark : options.highWatermark / 2;
+        std::shared_lock<std::shared_mutex> lock(topicsMutex);
+        for (auto &entry : topics)
+        {
+            Topic &topic = *entry.second;
+            auto found = floors.find(&topic);
+            long long floor = found == floors.end() ? LLONG_MAX : found->second;
+            topic.floor.store(floor);
+
+            std::lock_guard<std::mutex> write(topic.writeMutex);
+            if (topic.paused.empty())
+                continue;
+            long long next = topic.stream.GetNextOffset() + topic.stream.GetStagedCount();
+            if (next - floor <= low)
+            {
+                for (int connection : topic.paused)
+                {
+                    server.ResumeReading(connection);
+                }
+                topic.paused.clear();
+            }
+        }
+    }
+
+    void Dispatch()
+    {
+        std::vector<epoll_event> events(64);
+        bool more = true;
+        while (true)
+        {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), more ? 0 : -1);
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+            for (int i = 0; i < ready; ++i)
+            {
+                if (events[i].data.fd != wakeFd)
+                    continue;
+                unsigned long long value;
+                if (::read(wakeFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                    throw std::system_error(errno, std::generic_category(), "eventfd read");
+                wakePending.store(false);
+            }
+            if (stopping.load())
+                return;
+            more = PumpAll();
+            if (options.highWatermark > 0)
+                ResumeDrained();
+        }
+    }
+
+public:
+    explicit Broker(const Options &options)
+        : options(options),
+          server([this](int connection, std::string_view message) { OnFrame(connection, message); },
+                 options.server)
+    {
+        if (options.deliveryBatch <= 0 || options.deliveryBatch > IOV_MAX / 2)
+            throw std::invalid_argument("Delivery batch must be between 1 and IOV_MAX / 2");
+        if (options.maxTopics <= 0 || options.groupCommit <= 0)
+            throw std::invalid_argument("Topic limit and group size must be positive");
+        if (options.highWatermark < 0 || options.lowWatermark < 0 ||
+            (options.highWatermark > 0 && options.lowWatermark >= options.highWatermark))
+            throw std::invalid_argument("Low watermark must be below the high watermark");
+        if (options.server.framing == FramingMode::NewlineDelimited && !IsValidTopic(options.defaultTopic))
+            throw std::invalid_argument("Invalid default topic");
+        server.SetCloseHandler([this](int connection) { OnClose(connection); });
+
+        headers.resize(static_cast<size_t>(options.deliveryBatch) * MAX_TOPIC_HEADER_BYTES);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0)
+            throw std::system_error(errno, std::generic_category(), "epoll_create1");
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0)
+        {
+            int error = errno;
+            ::close(epollFd);
+            throw std::system_error(error, std::generic_category(), "eventfd");
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    }
+
+    Broker(const Broker &) = delete;
+    Broker &operator=(const Broker &) = delete;
+
+    ~Broker()
+    {
+        Stop();
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    void Start()
+    {
+        server.Start();
+        stopping.store(false);
+        dispatcher = std::thread([this] { Dispatch(); });
+    }
+
+    // The dispatcher goes first: it may still be resuming connections of
+    // the server's loops.
+    void Stop()
+    {
+        if (dispatcher.joinable())
+        {
+            stopping.store(true);
+            wakePending.store(false);
+            Wake();
+            dispatcher.join();
+        }
+        server.Stop();
+    }
+
+    // Creates a topic with its own retention. Throws if the name is not
+    // made of letters, digits, '.', '_' and '-', or the topic exists.
+    void CreateTopic(const std::string &name, const RetentionPolicy &retention)
+    {
+        if (!IsValidTopic(name))
+            throw std::invalid_argument("Invalid topic name");
+        std::unique_lock<std::shared_mutex> lock(topicsMutex);
+        if (topics.count(name) > 0)
+            throw std::invalid_argument("Topic already exists");
+        topics[name] = MakeTopic(name, retention);
+    }
+
+    // Publishes `body` to `topic` as if it had arrived from a client.
+    // Returns its offset, or -1 if the topic was rejected.
+    long long Publish(std::string_view topic, std::string_view body)
+    {
+        return PublishFrom(-1, topic, body);
+    }
+
+    // Publishes group-committed messages and applies age-based retention
+    // on every topic.
+    void Flush()
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(topicsMutex);
+            for (auto &entry : topics)
+            {
+                std::lock_guard<std::mutex> write(entry.second->writeMutex);
+                entry.second->stream.Flush();
+                entry.second->stream.EvictExpired();
+            }
+        }
+        Wake();
+    }
+
+    // Calls visit(name, stream) for every topic while holding its write
+    // lock, so the stream can be inspected but must not be waited on.
+    template <typename Visit>
+    void ForEachTopic(Visit &&visit) const
+    {
+        std::shared_lock<std::shared_mutex> lock(topicsMutex);
+        for (const auto &entry : topics)
+        {
+            std::lock_guard<std::mutex> write(entry.second->writeMutex);
+            visit(entry.first, static_cast<const Stream &>(entry.second->stream));
+        }
+    }
+
+    int GetPort() const
+    {
+        return server.GetPort();
+    }
+
+    ReceiveBackend GetServerBackend() const
+    {
+        return server.GetBackend();
+    }
+
+    StreamServer::Stats GetServerStats() const
+    {
+        return server.GetStats();
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.published = published.load(std::memory_order_relaxed);
+        stats.rejected = rejected.load(std::memory_order_relaxed);
+        stats.subscribed = subscribed.load(std::memory_order_relaxed);
+        stats.delivered = delivered.load(std::memory_order_relaxed);
+        stats.deliveredBytes = deliveredBytes.load(std::memory_order_relaxed);
+        stats.writes = writes.load(std::memory_order_relaxed);
+        stats.dropped = dropped.load(std::memory_order_relaxed);
+        stats.throttled = throttled.load(std::memory_order_relaxed);
+        stats.acknowledged = acknowledged.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
@@ -0,0 +1,231 @@
+#pragma once
+#include "include/Network/ReceiveRing.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Wire format shared by StreamServer, Broker and SenderClient. LengthPrefixed frames
+// are an unsigned LEB128 varint byte count followed by the payload;
+// NewlineDelimited frames are the payload followed by '\n'.
+enum class FramingMode
+{
+    LengthPrefixed,
+    NewlineDelimited
+};
+
+static constexpr int MAX_VARINT_BYTES = 10;
+
+inline int EncodeVarint(uint64_t value, char *out)
+{
+    int count = 0;
+    while (value >= 0x80)
+    {
+        out[count++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[count++] = static_cast<char>(value);
+    return count;
+}
+
+inline void AppendFrame(std::string &out, std::string_view payload,
+                        FramingMode mode = FramingMode::LengthPrefixed)
+{
+    if (mode == FramingMode::NewlineDelimited)
+    {
+        out.append(payload.data(), payload.size());
+        out.push_back('\n');
+        return;
+    }
+    char header[MAX_VARINT_BYTES];
+    out.append(header, EncodeVarint(payload.size(), header));
+    out.append(payload.data(), payload.size());
+}
+
+// Reads a varint from the front of `bytes`. Returns the number of bytes it
+// took, or 0 if `bytes` ends inside it or it is longer than a uint64_t.
+inline int DecodeVarint(std::string_view bytes, uint64_t &value)
+{
+    value = 0;
+    for (size_t i = 0; i < bytes.size() && i < MAX_VARINT_BYTES; ++i)
+    {
+        unsigned char byte = static_cast<unsigned char>(bytes[i]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0)
+            return static_cast<int>(i + 1);
+    }
+    return 0;
+}
+
+// Payload of a length-prefixed frame addressed to a topic: a kind byte, the
+// topic as a varint length and its bytes, a varint holding offset + 1 (zero
+// for none), then the body. Publish carries a message; Subscribe asks for
+// the topic from `offset` on, or from the next message without one; Deliver
+// is a message pushed to a subscriber with the offset it was stored at.
+// A Publish that carries an offset asks for an Ack: the offset is an opaque
+// tag the client picks, and the Ack returns it as a varint body together
+// with the offset the message was stored at, or none if it was rejected.
+enum class FrameKind : char
+{
+    Publish = 1,
+    Subscribe = 2,
+    Deliver = 3,
+    Ack = 4
+};
+
+static constexpr size_t MAX_TOPIC_LENGTH = 255;
+static constexpr int MAX_TOPIC_HEADER_BYTES = MAX_VARINT_BYTES + 1 + MAX_VARINT_BYTES + MAX_TOPIC_LENGTH + MAX_VARINT_BYTES;
+
+struct TopicFrame
+{
+    FrameKind kind;
+    std::string_view topic;
+    long long offset;
+    std::string_view body;
+};
+
+// Writes the outer length prefix and the topic header of a frame whose body
+// is `bodySize` bytes, so the body itself can be sent from where it lies.
+// The topic must be at most MAX_TOPIC_LENGTH bytes and `out` needs
+// MAX_TOPIC_HEADER_BYTES.
+inline int EncodeTopicHeader(char *out, FrameKind kind, std::string_view topic, long long offset, size_t bodySize)
+{
+    char inner[MAX_TOPIC_HEADER_BYTES];
+    int length = 0;
+    inner[length++] = static_cast<char>(kind);
+    length += EncodeVarint(topic.size(), inner + length);
+    std::memcpy(inner + length, topic.data(), topic.size());
+    length += static_cast<int>(topic.size());
+    length += EncodeVarint(static_cast<uint64_t>(offset + 1), inner + length);
+
+    int prefix = EncodeVarint(length + bodySize, out);
+    std::memcpy(out + prefix, inner, length);
+    return prefix + length;
+}
+
+inline void AppendTopicFrame(std::string &out, FrameKind kind, std::string_view topic,
+                             std::string_view body = std::string_view(), long long offset = -1)
+{
+    if (topic.size() > MAX_TOPIC_LENGTH)
+        throw std::invalid_argument("Topic name is too long");
+    char header[MAX_TOPIC_HEADER_BYTES];
+    out.append(header, EncodeTopicHeader(header, kind, topic, offset, body.size()));
+    out.append(body.data(), body.size());
+}
+
+// Splits a frame payload into its parts; false if it is not a topic frame.
+inline bool ParseTopicFrame(std::string_view payload, TopicFrame &frame)
+{
+    if (payload.empty())
+        return false;
+    char kind = payload[0];
+    if (kind < static_cast<char>(FrameKind::Publish) || kind > static_cast<char>(FrameKind::Ack))
+        return false;
+    frame.kind = static_cast<FrameKind>(kind);
+    payload.remove_prefix(1);
+
+    uint64_t topicLength = 0;
+    int used = DecodeVarint(payload, topicLength);
+    if (used == 0 || topicLength > MAX_TOPIC_LENGTH || payload.size() - used < topicLength)
+        return false;
+    frame.topic = payload.substr(used, topicLength);
+    payload.remove_prefix(used + topicLength);
+
+    uint64_t offset = 0;
+    used = DecodeVarint(payload, offset);
+    if (used == 0)
+        return false;
+    frame.offset = static_cast<long long>(offset) - 1;
+    frame.body = payload.substr(used);
+    return true;
+}
+
+// Cuts complete frames out of a connection's ReceiveRing. Frames are passed
+// to the callback as views into the ring and consumed once it returns, so a
+// callback that keeps a frame must copy it.
+class FrameDecoder
+{
+public:
+    enum class Status
+    {
+        NeedMore,
+        Malformed,
+        TooLarge
+    };
+
+private:
+    FramingMode mode;
+    size_t maxFrame;
+    size_t scanned = 0;
+    std::string scratch;
+
+public:
+    explicit FrameDecoder(FramingMode mode = FramingMode::LengthPrefixed, size_t maxFrame = 16 * 1024 * 1024)
+        : mode(mode), maxFrame(maxFrame) {}
+
+    // Hands every complete frame in `ring` to onFrame(string_view) and
+    // returns why it stopped. On NeedMore the ring has been grown if the
+    // pending frame would not otherwise fit.
+    template <typename OnFrame>
+    Status Drain(ReceiveRing &ring, OnFrame &&onFrame)
+    {
+        while (true)
+        {
+            size_t available = ring.GetLength();
+            size_t header = 0;
+            size_t length = 0;
+
+            if (mode == FramingMode::NewlineDelimited)
+            {
+                size_t newline = ring.Find('\n', scanned);
+                if (newline == std::string_view::npos)
+                {
+                    scanned = available;
+                    if (available > maxFrame)
+                        return Status::TooLarge;
+                    if (ring.IsFull())
+                        ring.Reserve(available + 1);
+                    return Status::NeedMore;
+                }
+                length = newline;
+                scanned = 0;
+                onFrame(ring.View(0, length, scratch));
+                ring.Consume(length + 1);
+                continue;
+            }
+
+            uint64_t value = 0;
+            bool complete = false;
+            for (size_t i = 0; i < available && i < MAX_VARINT_BYTES; ++i)
+            {
+                unsigned char byte = static_cast<unsigned char>(ring[i]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+                if ((byte & 0x80) == 0)
+                {
+                    header = i + 1;
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete)
+                return available >= MAX_VARINT_BYTES ? Status::Malformed : Status::NeedMore;
+            if (value > maxFrame)
+                return Status::TooLarge;
+
+            length = static_cast<size_t>(value);
+            if (available < header + length)
+            {
+                ring.Reserve(header + length);
+                return Status::NeedMore;
+            }
+            onFrame(ring.View(header, length, scratch));
+            ring.Consume(header + length);
+        }
+    }
+
+    FramingMode GetMode() const
+    {
+        return mode;
+    }
+};
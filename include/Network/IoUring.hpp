@@ -0,0 +1,315 @@
+#pragma once
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+// The part of io_uring StreamServer needs, on raw syscalls rather than
+// liburing: the submission and completion rings mapped from the kernel,
+// plus one ring of provided buffers that multishot receives pick from.
+// Preparing requests and reaping completions touch only shared memory;
+// Submit is the one system call, and it both hands over everything
+// prepared since the last call and waits for completions. Single thread.
+class IoUring
+{
+private:
+    int fd = -1;
+    unsigned features = 0;
+
+    void *sqMapping = MAP_FAILED;
+    size_t sqMappingSize = 0;
+    void *cqMapping = MAP_FAILED;
+    size_t cqMappingSize = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe *cqes = nullptr;
+    // Prepared but not yet submitted.
+    unsigned prepared = 0;
+
+    // The provided buffer ring is an array of io_uring_buf whose first
+    // entry's last field doubles as the tail. Not io_uring_buf_ring: in C++
+    // the kernel header's flexible array macro leaves an empty struct in
+    // front of `bufs`, which moves every entry 8 bytes along.
+    io_uring_buf *buffers = nullptr;
+    static_assert(sizeof(io_uring_buf) == 16 && offsetof(io_uring_buf, resv) == 14,
+                  "The buffer ring tail is the resv field of its first entry");
+    size_t buffersSize = 0;
+    std::unique_ptr<char[]> bufferMemory;
+    unsigned bufferCount = 0;
+    unsigned bufferSize = 0;
+    unsigned short bufferGroup = 0;
+    unsigned short bufferTail = 0;
+
+    template <typename T>
+    T *At(void *base, unsigned offset)
+    {
+        return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+    }
+
+    void Release()
+    {
+        if (buffers)
+            munmap(buffers, buffersSize);
+        if (sqes != MAP_FAILED)
+            munmap(sqes, sqesSize);
+        if (cqMapping != MAP_FAILED && cqMapping != sqMapping)
+            munmap(cqMapping, cqMappingSize);
+        if (sqMapping != MAP_FAILED)
+            munmap(sqMapping, sqMappingSize);
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+
+    // The ring indices are shared with the kernel, which reads what we
+    // store with acquire semantics and publishes with release.
+    template <typename T>
+    static T Load(const T &index)
+    {
+        return __atomic_load_n(&index, __ATOMIC_ACQUIRE);
+    }
+
+    template <typename T>
+    static void Store(T &index, T value)
+    {
+        __atomic_store_n(&index, value, __ATOMIC_RELEASE);
+    }
+
+    static void Check(bool ok, const char *what)
+    {
+        if (!ok)
+            throw std::system_error(errno, std::generic_category(), what);
+    }
+
+public:
+    explicit IoUring(unsigned entries)
+    {
+        // The kernel remembers the thread that sets a ring up and interrupts
+        // it when the ring is torn down, which turns up as EINTR from
+        // whatever blocking call that thread is in (a recv with a timeout,
+        // say). A thread that exits straight away has nothing to interrupt.
+        io_uring_params params{};
+        int error = 0;
+        std::thread([&]
+                    {
+                        params.flags = IORING_SETUP_COOP_TASKRUN;
+                        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                        if (fd < 0 && errno == EINVAL)
+                        {
+                            params = io_uring_params{};
+                            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                        }
+                        error = errno;
+                    })
+            .join();
+        errno = error;
+        Check(fd >= 0, "io_uring_setup");
+        features = params.features;
+
+        try
+        {
+            sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (features & IORING_FEAT_SINGLE_MMAP)
+                sqMappingSize = cqMappingSize = std::max(sqMappingSize, cqMappingSize);
+            sqMapping = mmap(nullptr, sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_SQ_RING);
+            Check(sqMapping != MAP_FAILED, "mmap io_uring submission ring");
+            if (features & IORING_FEAT_SINGLE_MMAP)
+            {
+                cqMapping = sqMapping;
+            }
+            else
+            {
+                cqMapping = mmap(nullptr, cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                 IORING_OFF_CQ_RING);
+                Check(cqMapping != MAP_FAILED, "mmap io_uring completion ring");
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            Check(sqes != MAP_FAILED, "mmap io_uring entries");
+        }
+        catch (...)
+        {
+            Release();
+            throw;
+        }
+
+        sqHead = At<unsigned>(sqMapping, params.sq_off.head);
+        sqTail = At<unsigned>(sqMapping, params.sq_off.tail);
+        sqMask = *At<unsigned>(sqMapping, params.sq_off.ring_mask);
+        sqEntries = *At<unsigned>(sqMapping, params.sq_off.ring_entries);
+        sqArray = At<unsigned>(sqMapping, params.sq_off.array);
+        cqHead = At<unsigned>(cqMapping, params.cq_off.head);
+        cqTail = At<unsigned>(cqMapping, params.cq_off.tail);
+        cqMask = *At<unsigned>(cqMapping, params.cq_off.ring_mask);
+        cqes = At<io_uring_cqe>(cqMapping, params.cq_off.cqes);
+    }
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    ~IoUring()
+    {
+        Release();
+    }
+
+    // Whether this kernel has everything StreamServer's io_uring loop uses:
+    // provided buffer rings (5.19) and multishot accept and receive (6.0).
+    static bool IsSupported()
+    {
+        utsname name;
+        int major = 0;
+        int minor = 0;
+        if (uname(&name) < 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6)
+            return false;
+        try
+        {
+            IoUring probe(4);
+            probe.ProvideBuffers(0, 1, 64);
+            return true;
+        }
+        catch (const std::system_error &)
+        {
+            return false;
+        }
+    }
+
+    // Registers `count` buffers of `size` bytes each as buffer group
+    // `group`; `count` must be a power of two.
+    void ProvideBuffers(unsigned short group, unsigned count, unsigned size)
+    {
+        if (buffers)
+            throw std::logic_error("Buffers are already provided");
+        if (count == 0 || count > 32768 || (count & (count - 1)) != 0 || size == 0)
+            throw std::invalid_argument("Buffer count must be a power of two up to 32768");
+        buffersSize = count * sizeof(io_uring_buf);
+        void *ring = mmap(nullptr, buffersSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        Check(ring != MAP_FAILED, "mmap buffer ring");
+        buffers = static_cast<io_uring_buf *>(ring);
+
+        io_uring_buf_reg registration{};
+        registration.ring_addr = reinterpret_cast<uint64_t>(ring);
+        registration.ring_entries = count;
+        registration.bgid = group;
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+        {
+            int error = errno;
+            munmap(ring, buffersSize);
+            buffers = nullptr;
+            throw std::system_error(error, std::generic_category(), "IORING_REGISTER_PBUF_RING");
+        }
+        bufferMemory.reset(new char[static_cast<size_t>(count) * size]);
+        bufferCount = count;
+        bufferSize = size;
+        bufferGroup = group;
+        for (unsigned id = 0; id < count; ++id)
+        {
+            Recycle(static_cast<unsigned short>(id));
+        }
+    }
+
+    unsigned short GetBufferGroup() const
+    {
+        return bufferGroup;
+    }
+
+    // The first `length` bytes of provided buffer `id`.
+    std::string_view Buffer(unsigned short id, size_t length) const
+    {
+        return std::string_view(bufferMemory.get() + static_cast<size_t>(id) * bufferSize, length);
+    }
+
+    // Hands provided buffer `id` back to the kernel.
+    void Recycle(unsigned short id)
+    {
+        io_uring_buf &entry = buffers[bufferTail & (bufferCount - 1)];
+        entry.addr = reinterpret_cast<uint64_t>(bufferMemory.get() + static_cast<size_t>(id) * bufferSize);
+        entry.len = bufferSize;
+        entry.bid = id;
+        ++bufferTail;
+        Store(buffers[0].resv, bufferTail);
+    }
+
+    // A zeroed submission entry, submitting what is queued first if the
+    // ring is full. An entry is only reused once the kernel has consumed
+    // it; a submit that is interrupted is retried, and one that frees no
+    // entry throws.
+    io_uring_sqe *Prepare()
+    {
+        unsigned tail = *sqTail;
+        while (tail - Load(*sqHead) >= sqEntries)
+        {
+            unsigned head = Load(*sqHead);
+            if (Submit(0) && Load(*sqHead) == head)
+                throw std::system_error(EBUSY, std::generic_category(), "io_uring submission queue is full");
+        }
+        unsigned index = tail & sqMask;
+        io_uring_sqe *entry = &sqes[index];
+        std::memset(entry, 0, sizeof(*entry));
+        sqArray[index] = index;
+        Store(*sqTail, tail + 1);
+        ++prepared;
+        return entry;
+    }
+
+    // Submits everything prepared and waits until at least `waitFor`
+    // completions are ready. Returns false if a signal interrupted the wait.
+    bool Submit(unsigned waitFor)
+    {
+        unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int submitted = static_cast<int>(syscall(__NR_io_uring_enter, fd, prepared, waitFor, flags, nullptr, 0));
+        if (submitted < 0)
+        {
+            if (errno == EINTR)
+                return false;
+            throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+        }
+        prepared -= static_cast<unsigned>(submitted);
+        return true;
+    }
+
+    // Calls onCompletion(const io_uring_cqe &) for every completion ready
+    // now and returns how many there were.
+    template <typename OnCompletion>
+    unsigned Reap(OnCompletion &&onCompletion)
+    {
+        unsigned head = *cqHead;
+        unsigned tail = Load(*cqTail);
+        unsigned count = 0;
+        while (head != tail)
+        {
+            // Copied out so the slot can be released before the callback
+            // prepares new requests.
+            io_uring_cqe completion = cqes[head & cqMask];
+            ++head;
+            Store(*cqHead, head);
+            onCompletion(completion);
+            ++count;
+            if (head == tail)
+                tail = Load(*cqTail);
+        }
+        return count;
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Per-connection receive buffer: a power-of-two byte ring filled straight
+// from the socket with readv into its (at most two) free spans. Ranges are
+// handed out as string_views into the ring; only a range that wraps past
+// the end is assembled into a caller-supplied scratch string.
+class ReceiveRing
+{
+private:
+    std::unique_ptr<char[]> data;
+    size_t capacity = 0;
+    size_t head = 0;
+    size_t size = 0;
+
+    size_t Wrap(size_t offset) const
+    {
+        return (head + offset) & (capacity - 1);
+    }
+
+    void CopyOut(size_t offset, size_t length, char *out) const
+    {
+        size_t start = Wrap(offset);
+        size_t first = std::min(length, capacity - start);
+        std::memcpy(out, data.get() + start, first);
+        std::memcpy(out + first, data.get(), length - first);
+    }
+
+public:
+    explicit ReceiveRing(size_t initialCapacity = 16 * 1024)
+    {
+        Reserve(std::max<size_t>(initialCapacity, 1));
+    }
+
+    // Grows the ring to at least `count` bytes, rounded up to a power of two.
+    void Reserve(size_t count)
+    {
+        if (count <= capacity)
+            return;
+        size_t newCapacity = capacity == 0 ? 1024 : capacity;
+        while (newCapacity < count)
+            newCapacity *= 2;
+
+        std::unique_ptr<char[]> newData(new char[newCapacity]);
+        if (size > 0)
+            CopyOut(0, size, newData.get());
+        data = std::move(newData);
+        capacity = newCapacity;
+        head = 0;
+    }
+
+    // One readv into the free space. Returns what read returns: the byte
+    // count, 0 at end of stream, or -1 with errno set. A full ring reads
+    // nothing and returns -1 with ENOBUFS.
+    ssize_t FillFrom(int fd)
+    {
+        size_t free = capacity - size;
+        if (free == 0)
+        {
+            errno = ENOBUFS;
+            return -1;
+        }
+        size_t tail = Wrap(size);
+        iovec spans[2];
+        int spanCount = 1;
+        spans[0].iov_base = data.get() + tail;
+        spans[0].iov_len = std::min(free, capacity - tail);
+        if (spans[0].iov_len < free)
+        {
+            spans[1].iov_base = data.get();
+            spans[1].iov_len = free - spans[0].iov_len;
+            spanCount = 2;
+        }
+        ssize_t count = readv(fd, spans, spanCount);
+        if (count > 0)
+            size += count;
+        return count;
+    }
+
+    void Append(std::string_view bytes)
+    {
+        Reserve(size + bytes.size());
+        size_t tail = Wrap(size);
+        size_t first = std::min(bytes.size(), capacity - tail);
+        std::memcpy(data.get() + tail, bytes.data(), first);
+        std::memcpy(data.get(), bytes.data() + first, bytes.size() - first);
+        size += bytes.size();
+    }
+
+    char operator[](size_t offset) const
+    {
+        return data[Wrap(offset)];
+    }
+
+    // The bytes [offset, offset + length) as one contiguous view. The view
+    // points into the ring unless the range wraps, in which case it is
+    // copied into `scratch`; either way it is valid until the next Consume,
+    // FillFrom or Reserve.
+    std::string_view View(size_t offset, size_t length, std::string &scratch) const
+    {
+        if (offset + length > size)
+            throw std::out_of_range("Range is outside the buffered bytes");
+        size_t start = Wrap(offset);
+        if (start + length <= capacity)
+            return std::string_view(data.get() + start, length);
+        scratch.resize(length);
+        CopyOut(offset, length, &scratch[0]);
+        return std::string_view(scratch.data(), length);
+    }
+
+    // Offset of the first `byte` at or after `from`, or npos.
+    size_t Find(char byte, size_t from) const
+    {
+        while (from < size)
+        {
+            size_t start = Wrap(from);
+            size_t span = std::min(size - from, capacity - start);
+            const void *match = std::memchr(data.get() + start, byte, span);
+            if (match)
+                return from + (static_cast<const char *>(match) - (data.get() + start));
+            from += span;
+        }
+        return std::string_view::npos;
+    }
+
+    void Consume(size_t count)
+    {
+        if (count > size)
+            throw std::out_of_range("Cannot consume more than is buffered");
+        head = Wrap(count);
+        size -= count;
+        if (size == 0)
+            head = 0;
+    }
+
+    size_t GetLength() const
+    {
+        return size;
+    }
+
+    size_t GetCapacity() const
+    {
+        return capacity;
+    }
+
+    bool IsFull() const
+    {
+        return size == capacity;
+    }
+};
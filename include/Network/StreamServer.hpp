@@ -0,0 +1,809 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "include/Network/Framing.hpp"
+#include "include/Network/IoUring.hpp"
+#include "include/Network/ReceiveRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// TCP server built on edge-triggered epoll. Every event loop runs on its own
+// thread with its own non-blocking listening socket; with more than one loop
+// the sockets share the port through SO_REUSEPORT and the kernel spreads
+// incoming connections across them. Each readable socket is drained until
+// EAGAIN into the connection's ReceiveRing, and every complete frame is
+// passed to the message handler as a view into that ring, valid only for
+// the duration of the call. With several loops the handler is called
+// concurrently and must synchronise itself.
+//
+// Each loop receives through one of two backends, chosen at construction.
+// Epoll reads a ready socket with readv until a read comes back short,
+// which under edge triggering means the socket is drained, so a burst
+// costs one epoll_wait and one readv per socket rather than ending every
+// drain with a read that returns EAGAIN. IoUring keeps a multishot accept
+// and one multishot receive per connection armed on a ring with provided
+// buffers; the kernel fills the buffers as data arrives and a single
+// io_uring_enter reaps every completion, so there are no per-socket
+// syscalls at all. Kernels without what it needs get Epoll instead.
+//
+// For flow control the handler may call PauseReading on its connection:
+// the loop finishes the frames already in the ring, drops read interest
+// and leaves the rest in the socket, so TCP pushes back on the sender.
+// ResumeReading, from any thread, turns reading back on.
+enum class ReceiveBackend
+{
+    Epoll,
+    IoUring
+};
+
+class StreamServer
+{
+public:
+    using MessageHandler = std::function<void(int connection, std::string_view message)>;
+    using CloseHandler = std::function<void(int connection)>;
+
+    struct Options
+    {
+        // Port 0 binds a free port; GetPort reports it after Start.
+        int port = 8080;
+        int loops = 1;
+        int backlog = SOMAXCONN;
+        int maxEvents = 256;
+        FramingMode framing = FramingMode::LengthPrefixed;
+        // Initial size of each connection's receive ring; it grows to fit
+        // the largest frame, up to maxFrame bytes.
+        int receiveBuffer = 16 * 1024;
+        int maxFrame = 16 * 1024 * 1024;
+        ReceiveBackend backend = ReceiveBackend::Epoll;
+        // IoUring only: provided buffers per loop, a power of two, each
+        // receiveBuffer bytes.
+        int uringBuffers = 256;
+    };
+
+    struct Stats
+    {
+        long long accepted = 0;
+        long long closed = 0;
+        long long bytes = 0;
+        long long reads = 0;
+        long long messages = 0;
+        long long malformed = 0;
+        // Accepts that failed, mostly for want of descriptors.
+        long long acceptFailures = 0;
+        // System calls on the receive path: epoll_wait or io_uring_enter,
+        // and every readv including those that found nothing.
+        long long waits = 0;
+        long long receiveCalls = 0;
+        long long pauses = 0;
+        long long resumes = 0;
+        // Time connections spent paused, counted when they resume or close.
+        long long pausedMicroseconds = 0;
+    };
+
+private:
+    struct Connection
+    {
+        ReceiveRing ring;
+        FrameDecoder decoder;
+        bool paused = false;
+        std::chrono::steady_clock::time_point pausedAt;
+        // IoUring: whether a multishot receive is outstanding, and which
+        // connection on this descriptor it belongs to.
+        bool armed = false;
+        unsigned generation = 0;
+
+        explicit Connection(const Options &options)
+            : ring(options.receiveBuffer), decoder(options.framing, options.maxFrame) {}
+    };
+
+    class Loop
+    {
+    private:
+        StreamServer &server;
+        int epollFd = -1;
+        int listenFd = -1;
+        int wakeFd = -1;
+        std::vector<std::unique_ptr<Connection>> connections;
+        std::thread thread;
+        std::atomic<bool> stopping{false};
+        std::mutex resumeMutex;
+        std::vector<int> resumeQueue;
+        std::unique_ptr<IoUring> uring;
+        unsigned generations = 0;
+        // Epoll: an accept failed and the backlog is waiting for a free
+        // descriptor. IoUring: whether the multishot accept is outstanding.
+        bool acceptStalled = false;
+        bool acceptArmed = false;
+
+        std::atomic<long long> accepted{0};
+        std::atomic<long long> closed{0};
+        std::atomic<long long> bytes{0};
+        std::atomic<long long> reads{0};
+        std::atomic<long long> messages{0};
+        std::atomic<long long> malformed{0};
+        std::atomic<long long> acceptFailures{0};
+        std::atomic<long long> waits{0};
+        std::atomic<long long> receiveCalls{0};
+        std::atomic<long long> pauses{0};
+        std::atomic<long long> resumes{0};
+        std::atomic<long long> pausedMicroseconds{0};
+
+        // Counters are written by the loop thread only, so a relaxed
+        // load-add-store is enough and avoids a locked instruction.
+        static void Add(std::atomic<long long> &counter, long long amount)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        void Watch(int fd, unsigned events, int operation = EPOLL_CTL_ADD)
+        {
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+            if (epoll_ctl(epollFd, operation, fd, &event) < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+        }
+
+        void AddPausedTime(Connection &connection)
+        {
+            auto paused = std::chrono::steady_clock::now() - connection.pausedAt;
+            Add(pausedMicroseconds, std::chrono::duration_cast<std::chrono::microseconds>(paused).count());
+        }
+
+        void AcceptAll()
+        {
+            while (true)
+            {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                        continue;
+                    // EAGAIN means the backlog is drained; on EMFILE and
+                    // similar the rest stays queued until a socket closes.
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    {
+                        Add(acceptFailures, 1);
+                        acceptStalled = true;
+                    }
+                    return;
+                }
+                if (fd >= static_cast<int>(connections.size()))
+                    connections.resize(fd + 1);
+                connections[fd] = std::make_unique<Connection>(server.options);
+                Watch(fd, EPOLLIN | EPOLLRDHUP | EPOLLET);
+                Add(accepted, 1);
+            }
+        }
+
+        void Close(int fd)
+        {
+            if (!uring)
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            else if (connections[fd]->armed)
+                CancelReceive(fd, *connections[fd]);
+            if (server.closeHandler)
+                server.closeHandler(fd);
+            // Resumes are queued by descriptor, so any still pending for
+            // this one must go before a new connection can reuse it.
+            for (auto &loop : server.loops)
+            {
+                loop->DiscardResume(fd);
+            }
+            if (connections[fd]->paused)
+                AddPausedTime(*connections[fd]);
+            connections[fd].reset();
+            Add(closed, 1);
+            ::close(fd);
+            // A descriptor is free again for an accept that ran out; it is
+            // likely this one, so the slot must already be empty.
+            if (uring && !acceptArmed)
+                ArmAccept();
+            if (!uring && acceptStalled)
+            {
+                acceptStalled = false;
+                AcceptAll();
+            }
+        }
+
+        // Hands every complete frame to the handler; false if the stream was
+        // malformed and the connection has been closed.
+        bool Deliver(int fd, Connection &connection)
+        {
+            FrameDecoder::Status status = connection.decoder.Drain(
+                connection.ring,
+                [&](std::string_view frame)
+                {
+                    Add(messages, 1);
+                    if (server.handler)
+                        server.handler(fd, frame);
+                });
+            if (status == FrameDecoder::Status::NeedMore)
+                return true;
+            Add(malformed, 1);
+            Close(fd);
+            return false;
+        }
+
+        // Reads until the socket is drained. A read that fills less than
+        // the free space has emptied it, and edge triggering reports
+        // anything that arrives later, so unless `untilAgain` asks for the
+        // EAGAIN (after a resume, or when the peer has hung up and the end
+        // of stream must be seen) that read is the last one.
+        void ReadAll(int fd, bool untilAgain)
+        {
+            Connection &connection = *connections[fd];
+            while (true)
+            {
+                size_t free = connection.ring.GetCapacity() - connection.ring.GetLength();
+                ssize_t count = connection.ring.FillFrom(fd);
+                Add(receiveCalls, 1);
+                if (count > 0)
+                {
+                    Add(bytes, count);
+                    Add(reads, 1);
+                    if (!Deliver(fd, connection) || connection.paused)
+                        return;
+                    if (!untilAgain && static_cast<size_t>(count) < free)
+                        return;
+                    continue;
+                }
+                if (count < 0 && errno == EINTR)
+                    continue;
+                if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    return;
+                Close(fd);
+                return;
+            }
+        }
+
+        void RunEpoll()
+        {
+            std::vector<epoll_event> events(server.options.maxEvents);
+            while (true)
+            {
+                int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+                Add(waits, 1);
+                if (ready < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "epoll_wait");
+                }
+                for (int i = 0; i < ready; ++i)
+                {
+                    int fd = events[i].data.fd;
+                    if (fd == wakeFd)
+                    {
+                        // Stop sets the flag before writing, so a wake-up
+                        // consumed here cannot hide a stop.
+                        if (stopping.load())
+                            return;
+                        ResumeQueued();
+                        if (stopping.load())
+                            return;
+                        continue;
+                    }
+                    if (fd == listenFd)
+                    {
+                        AcceptAll();
+                        continue;
+                    }
+                    if (!connections[fd])
+                        continue;
+                    // A paused connection is read again when it resumes,
+                    // unless the socket has failed outright.
+                    if (connections[fd]->paused)
+                    {
+                        if (events[i].events & (EPOLLHUP | EPOLLERR))
+                            Close(fd);
+                        continue;
+                    }
+                    // Read before honouring a hang-up so that data sent just
+                    // before the peer closed is still delivered.
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                        ReadAll(fd, (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+                }
+            }
+        }
+
+        // io_uring requests are told apart by the top byte of their
+        // user_data; receives also carry the descriptor and its generation,
+        // so completions for a connection that has since closed, and whose
+        // descriptor may have been reused, are recognised and dropped.
+        enum Request : uint64_t
+        {
+            ACCEPT = 1,
+            WAKE = 2,
+            RECEIVE = 3,
+            CANCEL = 4
+        };
+
+        static uint64_t Tag(Request request, int fd = 0, unsigned generation = 0)
+        {
+            return static_cast<uint64_t>(request) << 56 | static_cast<uint64_t>(generation & 0xFFFFFF) << 32 |
+                   static_cast<uint32_t>(fd);
+        }
+
+        void ArmAccept()
+        {
+            io_uring_sqe *entry = uring->Prepare();
+            entry->opcode = IORING_OP_ACCEPT;
+            entry->fd = listenFd;
+            entry->ioprio = IORING_ACCEPT_MULTISHOT;
+            entry->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+            entry->user_data = Tag(ACCEPT);
+            acceptArmed = true;
+        }
+
+        void ArmWake()
+        {
+            io_uring_sqe *entry = uring->Prepare();
+            entry->opcode = IORING_OP_POLL_ADD;
+            entry->fd = wakeFd;
+            entry->poll32_events = POLLIN;
+            entry->len = IORING_POLL_ADD_MULTI;
+            entry->user_data = Tag(WAKE);
+        }
+
+        void ArmReceive(int fd, Connection &connection)
+        {
+            io_uring_sqe *entry = uring->Prepare();
+            entry->opcode = IORING_OP_RECV;
+            entry->fd = fd;
+            entry->flags = IOSQE_BUFFER_SELECT;
+            entry->buf_group = uring->GetBufferGroup();
+            entry->ioprio = IORING_RECV_MULTISHOT;
+            entry->user_data = Tag(RECEIVE, fd, connection.generation);
+            connection.armed = true;
+        }
+
+        // The receive ends with -ECANCELED; `armed` stays set until then.
+        void CancelReceive(int fd, Connection &connection)
+        {
+            io_uring_sqe *entry = uring->Prepare();
+            entry->opcode = IORING_OP_ASYNC_CANCEL;
+            entry->fd = -1;
+            entry->addr = Tag(RECEIVE, fd, connection.generation);
+            entry->user_data = Tag(CANCEL);
+        }
+
+        // A multishot accept that ends in an error (EMFILE, ENFILE) would
+        // fail again straight away if re-armed, so it waits until a
+        // connection closes or the loop is woken.
+        void Accepted(const io_uring_cqe &completion)
+        {
+            int fd = completion.res;
+            if (!(completion.flags & IORING_CQE_F_MORE))
+            {
+                acceptArmed = false;
+                if (fd >= 0)
+                    ArmAccept();
+            }
+            if (fd < 0)
+            {
+                Add(acceptFailures, 1);
+                return;
+            }
+            if (fd >= static_cast<int>(connections.size()))
+                connections.resize(fd + 1);
+            connections[fd] = std::make_unique<Connection>(server.options);
+            connections[fd]->generation = ++generations;
+            Add(accepted, 1);
+            ArmReceive(fd, *connections[fd]);
+        }
+
+        void Received(const io_uring_cqe &completion)
+        {
+            int fd = static_cast<int>(static_cast<uint32_t>(completion.user_data));
+            unsigned generation = static_cast<unsigned>(completion.user_data >> 32) & 0xFFFFFF;
+            Connection *connection = nullptr;
+            if (fd < static_cast<int>(connections.size()) && connections[fd] &&
+                (connections[fd]->generation & 0xFFFFFF) == generation)
+                connection = connections[fd].get();
+
+            // The data leaves the provided buffer straight away, so the
+            // buffer can go back to the kernel before anything else runs.
+            if (completion.flags & IORING_CQE_F_BUFFER)
+            {
+                unsigned short id = static_cast<unsigned short>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (connection && completion.res > 0)
+                    connection->ring.Append(uring->Buffer(id, static_cast<size_t>(completion.res)));
+                uring->Recycle(id);
+            }
+            if (!connection)
+                return;
+            if (!(completion.flags & IORING_CQE_F_MORE))
+                connection->armed = false;
+
+            if (completion.res > 0)
+            {
+                Add(bytes, completion.res);
+                Add(reads, 1);
+                // Frames that arrive while paused wait in the ring.
+                if (!connection->paused && !Deliver(fd, *connection))
+                    return;
+            }
+            else if (completion.res != -ENOBUFS && completion.res != -ECANCELED)
+            {
+                // End of stream, or the socket failed.
+                Close(fd);
+                return;
+            }
+            // Ran out of provided buffers or was cancelled by a pause.
+            if (!connection->armed && !connection->paused)
+                ArmReceive(fd, *connection);
+        }
+
+        void RunUring()
+        {
+            ArmAccept();
+            ArmWake();
+            while (true)
+            {
+                Add(waits, 1);
+                if (!uring->Submit(1))
+                    continue;
+                bool woken = false;
+                uring->Reap([&](const io_uring_cqe &completion)
+                            {
+                                switch (completion.user_data >> 56)
+                                {
+                                case ACCEPT:
+                                    Accepted(completion);
+                                    break;
+                                case RECEIVE:
+                                    Received(completion);
+                                    break;
+                                case WAKE:
+                                    woken = true;
+                                    if (!(completion.flags & IORING_CQE_F_MORE))
+                                        ArmWake();
+                                    break;
+                                }
+                            });
+                if (!woken)
+                    continue;
+                if (stopping.load())
+                    return;
+                if (!acceptArmed)
+                    ArmAccept();
+                ResumeQueued();
+                if (stopping.load())
+                    return;
+            }
+        }
+
+        void Run()
+        {
+            if (uring)
+                RunUring();
+            else
+                RunEpoll();
+        }
+
+        void Wake()
+        {
+            unsigned long long one = 1;
+            if (::write(wakeFd, &one, sizeof(one)) < 0)
+                throw std::system_error(errno, std::generic_category(), "eventfd write");
+        }
+
+        void ResumeQueued()
+        {
+            unsigned long long count;
+            if (::read(wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+                throw std::system_error(errno, std::generic_category(), "eventfd read");
+            std::vector<int> queued;
+            {
+                std::lock_guard<std::mutex> lock(resumeMutex);
+                queued.swap(resumeQueue);
+            }
+            for (int fd : queued)
+            {
+                if (fd >= static_cast<int>(connections.size()) || !connections[fd] || !connections[fd]->paused)
+                    continue;
+                Connection &connection = *connections[fd];
+                connection.paused = false;
+                AddPausedTime(connection);
+                Add(resumes, 1);
+                if (uring)
+                {
+                    if (Deliver(fd, connection) && !connection.paused && !connection.armed)
+                        ArmReceive(fd, connection);
+                    continue;
+                }
+                Watch(fd, EPOLLIN | EPOLLRDHUP | EPOLLET, EPOLL_CTL_MOD);
+                ReadAll(fd, true);
+            }
+        }
+
+    public:
+        // Pointer to the loop running on this thread, if any.
+        static Loop *&Current()
+        {
+            static thread_local Loop *current = nullptr;
+            return current;
+        }
+
+        Loop(StreamServer &server, int listenFd)
+            : server(server), listenFd(listenFd)
+        {
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wakeFd < 0)
+                throw std::system_error(errno, std::generic_category(), "eventfd");
+            if (server.options.backend == ReceiveBackend::IoUring)
+            {
+                uring = std::make_unique<IoUring>(1024);
+                uring->ProvideBuffers(0, static_cast<unsigned>(server.options.uringBuffers),
+                                      static_cast<unsigned>(server.options.receiveBuffer));
+                return;
+            }
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_create1");
+            Watch(listenFd, EPOLLIN | EPOLLET);
+            Watch(wakeFd, EPOLLIN);
+        }
+
+        Loop(const Loop &) = delete;
+        Loop &operator=(const Loop &) = delete;
+
+        ~Loop()
+        {
+            Stop();
+            for (int fd = 0; fd < static_cast<int>(connections.size()); ++fd)
+            {
+                if (!connections[fd])
+                    continue;
+                if (server.closeHandler)
+                    server.closeHandler(fd);
+                ::close(fd);
+            }
+            uring.reset();
+            ::close(wakeFd);
+            if (epollFd >= 0)
+                ::close(epollFd);
+            ::close(listenFd);
+        }
+
+        void Start()
+        {
+            thread = std::thread([this]
+                                 {
+                                     Current() = this;
+                                     Run();
+                                 });
+        }
+
+        void Stop()
+        {
+            if (!thread.joinable())
+                return;
+            stopping.store(true);
+            Wake();
+            thread.join();
+        }
+
+        // Loop thread only.
+        void Pause(int fd)
+        {
+            if (fd < 0 || fd >= static_cast<int>(connections.size()) || !connections[fd])
+                throw std::invalid_argument("Connection does not belong to this loop");
+            Connection &connection = *connections[fd];
+            if (connection.paused)
+                return;
+            connection.paused = true;
+            connection.pausedAt = std::chrono::steady_clock::now();
+            Add(pauses, 1);
+            if (!uring)
+                Watch(fd, EPOLLRDHUP | EPOLLET, EPOLL_CTL_MOD);
+            else if (connection.armed)
+                CancelReceive(fd, connection);
+        }
+
+        // Any thread. A loop that does not own `fd` ignores it.
+        void RequestResume(int fd)
+        {
+            {
+                std::lock_guard<std::mutex> lock(resumeMutex);
+                resumeQueue.push_back(fd);
+            }
+            Wake();
+        }
+
+        // Any thread.
+        void DiscardResume(int fd)
+        {
+            std::lock_guard<std::mutex> lock(resumeMutex);
+            resumeQueue.erase(std::remove(resumeQueue.begin(), resumeQueue.end(), fd), resumeQueue.end());
+        }
+
+        void Collect(Stats &stats) const
+        {
+            stats.accepted += accepted.load(std::memory_order_relaxed);
+            stats.closed += closed.load(std::memory_order_relaxed);
+            stats.bytes += bytes.load(std::memory_order_relaxed);
+            stats.reads += reads.load(std::memory_order_relaxed);
+            stats.messages += messages.load(std::memory_order_relaxed);
+            stats.malformed += malformed.load(std::memory_order_relaxed);
+            stats.acceptFailures += acceptFailures.load(std::memory_order_relaxed);
+            stats.waits += waits.load(std::memory_order_relaxed);
+            stats.receiveCalls += receiveCalls.load(std::memory_order_relaxed);
+            stats.pauses += pauses.load(std::memory_order_relaxed);
+            stats.resumes += resumes.load(std::memory_order_relaxed);
+            stats.pausedMicroseconds += pausedMicroseconds.load(std::memory_order_relaxed);
+        }
+    };
+
+    Options options;
+    MessageHandler handler;
+    CloseHandler closeHandler;
+    std::vector<std::unique_ptr<Loop>> loops;
+    Stats stopped;
+    int boundPort = 0;
+
+    int OpenListener(int port) const
+    {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "socket");
+
+        int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (options.loops > 1 && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "SO_REUSEPORT");
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+            listen(fd, options.backlog) < 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "bind/listen");
+        }
+        return fd;
+    }
+
+    static int PortOf(int fd)
+    {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        if (getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) < 0)
+            throw std::system_error(errno, std::generic_category(), "getsockname");
+        return ntohs(address.sin_port);
+    }
+
+public:
+    explicit StreamServer(MessageHandler handler) : StreamServer(std::move(handler), Options()) {}
+
+    StreamServer(MessageHandler handler, const Options &options)
+        : options(options), handler(std::move(handler))
+    {
+        if (options.loops <= 0)
+            throw std::invalid_argument("Loop count must be positive");
+        if (options.receiveBuffer <= 0 || options.maxFrame <= 0 || options.maxEvents <= 0)
+            throw std::invalid_argument("Buffer sizes and event batch must be positive");
+        if (options.uringBuffers <= 0 || options.uringBuffers > 32768 ||
+            (options.uringBuffers & (options.uringBuffers - 1)) != 0)
+            throw std::invalid_argument("io_uring buffer count must be a power of two up to 32768");
+        if (options.backend == ReceiveBackend::IoUring && !IoUring::IsSupported())
+            this->options.backend = ReceiveBackend::Epoll;
+    }
+
+    StreamServer(const StreamServer &) = delete;
+    StreamServer &operator=(const StreamServer &) = delete;
+
+    ~StreamServer()
+    {
+        Stop();
+    }
+
+    // Called on the loop thread just before a connection's socket is closed,
+    // so anything else writing to it can stop first. Set before Start.
+    void SetCloseHandler(CloseHandler handler)
+    {
+        if (!loops.empty())
+            throw std::logic_error("StreamServer is already running");
+        closeHandler = std::move(handler);
+    }
+
+    void Start()
+    {
+        if (!loops.empty())
+            throw std::logic_error("StreamServer is already running");
+
+        int port = options.port;
+        for (int i = 0; i < options.loops; ++i)
+        {
+            int fd = OpenListener(port);
+            if (i == 0)
+                port = boundPort = PortOf(fd);
+            loops.push_back(std::make_unique<Loop>(*this, fd));
+        }
+        for (auto &loop : loops)
+        {
+            loop->Start();
+        }
+    }
+
+    void Stop()
+    {
+        for (auto &loop : loops)
+        {
+            loop->Stop();
+            loop->Collect(stopped);
+        }
+        loops.clear();
+    }
+
+    // Stops reading `connection` once the frames already received have been
+    // handled. Only valid inside the message handler, for a connection of
+    // the loop it runs on.
+    void PauseReading(int connection)
+    {
+        Loop *loop = Loop::Current();
+        if (!loop)
+            throw std::logic_error("PauseReading must be called from the message handler");
+        loop->Pause(connection);
+    }
+
+    // Reads `connection` again if it is paused; callable from any thread.
+    // A resume still pending when the connection closes is dropped, so it
+    // never reaches a later connection that reuses the descriptor; callers
+    // that remember paused connections must forget them in the close
+    // handler for the same reason.
+    void ResumeReading(int connection)
+    {
+        for (auto &loop : loops)
+        {
+            loop->RequestResume(connection);
+        }
+    }
+
+    int GetPort() const
+    {
+        return boundPort;
+    }
+
+    // The backend the loops use, which is Epoll if IoUring was asked for
+    // but is not supported.
+    ReceiveBackend GetBackend() const
+    {
+        return options.backend;
+    }
+
+    // Totals since construction, including loops that have been stopped.
+    Stats GetStats() const
+    {
+        Stats stats = stopped;
+        for (const auto &loop : loops)
+        {
+            loop->Collect(stats);
+        }
+        return stats;
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+// Circular bucket queue (Dial's algorithm): every key present must lie in
+// [current minimum, current minimum + range), which holds for monotone
+// extraction where a new key exceeds the extracted one by less than range.
+template <typename Key, typename Value>
+class BucketQueue
+{
+    static_assert(std::is_unsigned<Key>::value, "BucketQueue keys must be unsigned integers");
+
+private:
+    std::vector<std::vector<std::pair<Key, Value>>> buckets;
+    Key range;
+    Key cursor = 0;
+    int size = 0;
+
+    std::vector<std::pair<Key, Value>> &BucketAt(Key key)
+    {
+        return buckets[static_cast<size_t>(key % range)];
+    }
+
+    // An empty queue holds nothing the window has to cover, so a key on
+    // either side of it moves the window to start at that key.
+    void CheckKey(Key key)
+    {
+        if (size == 0 && (key < cursor || key - cursor >= range))
+            cursor = key;
+        if (key < cursor || key - cursor >= range)
+            throw std::invalid_argument("BucketQueue key is outside the active range");
+    }
+
+    void Advance()
+    {
+        while (BucketAt(cursor).empty())
+            ++cursor;
+    }
+
+public:
+    explicit BucketQueue(Key range) : range(range)
+    {
+        if (range == 0)
+            throw std::invalid_argument("BucketQueue range must be positive");
+        buckets.resize(static_cast<size_t>(range));
+    }
+
+    void Enqueue(Key key, const Value &value)
+    {
+        CheckKey(key);
+        BucketAt(key).emplace_back(key, value);
+        ++size;
+    }
+
+    void Enqueue(Key key, Value &&value)
+    {
+        CheckKey(key);
+        BucketAt(key).emplace_back(key, std::move(value));
+        ++size;
+    }
+
+    std::pair<Key, Value> Dequeue()
+    {
+        if (size == 0)
+        {
+            throw std::out_of_range("BucketQueue is empty");
+        }
+        Advance();
+        std::vector<std::pair<Key, Value>> &bucket = BucketAt(cursor);
+        std::pair<Key, Value> top = std::move(bucket.back());
+        bucket.pop_back();
+        --size;
+        return top;
+    }
+
+    const std::pair<Key, Value> &Peek()
+    {
+        if (size == 0)
+        {
+            throw std::out_of_range("BucketQueue is empty");
+        }
+        Advance();
+        return BucketAt(cursor).back();
+    }
+
+    Key GetRange() const
+    {
+        return range;
+    }
+
+    int GetLength() const
+    {
+        return size;
+    }
+
+    bool IsEmpty() const
+    {
+        return size == 0;
+    }
+};
@@ -0,0 +1,259 @@
+#pragma once
+#include "include/ISequence.hpp"
+#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Append-only sequence shared by many writer threads. A writer builds the
+// item, reserves an index with one fetch_add, moves the item into place and
+// marks the slot committed; the published length then advances over every
+// contiguous committed slot. The item is built before the index is taken so
+// that a throwing constructor cannot leave a slot that is never committed. Readers only see the published prefix, which never moves:
+// storage is a directory of segments of doubling size, and a segment, once
+// allocated, stays put until the sequence is destroyed. Readers take no
+// locks. The ISequence operations that build a new sequence return a copy
+// of the published prefix as an ArrayMutableSequence.
+template <typename T>
+class ConcurrentLogSequence : public ISequence<T>
+{
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "A reserved slot must always be filled, so moving T must not throw");
+
+private:
+    static constexpr std::size_t FIRST_SEGMENT_SIZE = 64;
+    static constexpr int SEGMENT_COUNT = 25;
+
+    struct Segment
+    {
+        std::unique_ptr<std::atomic<bool>[]> committed;
+        unsigned char *bytes;
+
+        explicit Segment(std::size_t size)
+            : committed(new std::atomic<bool>[size]),
+              bytes(static_cast<unsigned char *>(::operator new(size * sizeof(T), std::align_val_t(alignof(T)))))
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                committed[i].store(false, std::memory_order_relaxed);
+        }
+
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+
+        ~Segment()
+        {
+            ::operator delete(bytes, std::align_val_t(alignof(T)));
+        }
+
+        void *RawAt(std::size_t offset)
+        {
+            return bytes + offset * sizeof(T);
+        }
+
+        T *At(std::size_t offset) const
+        {
+            return std::launder(reinterpret_cast<T *>(bytes + offset * sizeof(T)));
+        }
+    };
+
+    std::atomic<Segment *> segments[SEGMENT_COUNT] = {};
+    alignas(64) std::atomic<std::size_t> reserved{0};
+    alignas(64) std::atomic<std::size_t> published{0};
+
+    static std::size_t SegmentSize(int segment)
+    {
+        return FIRST_SEGMENT_SIZE << segment;
+    }
+
+    // Segment k holds indices [F * (2^k - 1), F * (2^(k+1) - 1)).
+    static void Locate(std::size_t index, int &segment, std::size_t &offset)
+    {
+        std::size_t scaled = index / FIRST_SEGMENT_SIZE + 1;
+        segment = 63 - __builtin_clzll(scaled);
+        offset = index - FIRST_SEGMENT_SIZE * ((std::size_t(1) << segment) - 1);
+    }
+
+    Segment *SegmentFor(int segment)
+    {
+        Segment *existing = segments[segment].load(std::memory_order_acquire);
+        if (existing)
+            return existing;
+
+        Segment *fresh = new Segment(SegmentSize(segment));
+        if (segments[segment].compare_exchange_strong(existing, fresh, std::memory_order_acq_rel))
+            return fresh;
+        delete fresh;
+        return existing;
+    }
+
+    bool IsCommitted(std::size_t index) const
+    {
+        int segment;
+        std::size_t offset;
+        Locate(index, segment, offset);
+        Segment *owner = segments[segment].load(std::memory_order_acquire);
+        return owner && owner->committed[offset].load();
+    }
+
+    // Moves the watermark over committed slots. Whoever commits the slot the
+    // watermark is waiting on carries it forward over later slots too.
+    void Advance()
+    {
+        std::size_t mark = published.load();
+        while (mark < reserved.load() && IsCommitted(mark))
+        {
+            published.compare_exchange_weak(mark, mark + 1);
+        }
+    }
+
+    const T &Ref(int index) const
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= published.load(std::memory_order_acquire))
+            throw std::out_of_range("Index out of range");
+        int segment;
+        std::size_t offset;
+        Locate(static_cast<std::size_t>(index), segment, offset);
+        return *segments[segment].load(std::memory_order_acquire)->At(offset);
+    }
+
+    std::unique_ptr<ArrayMutableSequence<T>> Snapshot() const
+    {
+        auto copy = std::make_unique<ArrayMutableSequence<T>>();
+        int length = GetLength();
+        for (int i = 0; i < length; ++i)
+        {
+            copy->AppendInPlace(Ref(i));
+        }
+        return copy;
+    }
+
+public:
+    ConcurrentLogSequence() = default;
+
+    ConcurrentLogSequence(const ConcurrentLogSequence &) = delete;
+    ConcurrentLogSequence &operator=(const ConcurrentLogSequence &) = delete;
+
+    ~ConcurrentLogSequence()
+    {
+        for (int segment = 0; segment < SEGMENT_COUNT; ++segment)
+        {
+            Segment *owner = segments[segment].load(std::memory_order_relaxed);
+            if (!owner)
+                continue;
+            for (std::size_t offset = 0; offset < SegmentSize(segment); ++offset)
+            {
+                if (owner->committed[offset].load(std::memory_order_relaxed))
+                    owner->At(offset)->~T();
+            }
+            delete owner;
+        }
+    }
+
+    // Writer side; safe from any number of threads. Returns the index the
+    // item was stored at. It becomes visible to readers once every earlier
+    // index has been committed as well.
+    template <typename... Args>
+    int Emplace(Args &&...args)
+    {
+        T item(std::forward<Args>(args)...);
+        std::size_t index = reserved.fetch_add(1);
+        if (index >= FIRST_SEGMENT_SIZE * ((std::size_t(1) << SEGMENT_COUNT) - 1))
+            throw std::length_error("ConcurrentLogSequence is full");
+
+        int segment;
+        std::size_t offset;
+        Locate(index, segment, offset);
+        Segment *owner = SegmentFor(segment);
+        new (owner->RawAt(offset)) T(std::move(item));
+        owner->committed[offset].store(true);
+        Advance();
+        return static_cast<int>(index);
+    }
+
+    int Push(const T &item)
+    {
+        return Emplace(item);
+    }
+
+    int Push(T &&item)
+    {
+        return Emplace(std::move(item));
+    }
+
+    // Reader side.
+
+    const T &operator[](int index) const
+    {
+        return Ref(index);
+    }
+
+    T GetFirst() const override
+    {
+        if (GetLength() == 0)
+            throw std::out_of_range("Sequence is empty");
+        return Ref(0);
+    }
+
+    T GetLast() const override
+    {
+        int length = GetLength();
+        if (length == 0)
+            throw std::out_of_range("Sequence is empty");
+        return Ref(length - 1);
+    }
+
+    T Get(int index) const override
+    {
+        return Ref(index);
+    }
+
+    // The published watermark: every index below it is readable.
+    int GetLength() const override
+    {
+        return static_cast<int>(published.load(std::memory_order_acquire));
+    }
+
+    std::unique_ptr<ISequence<T>> GetSubsequence(int startIndex, int endIndex) const override
+    {
+        if (startIndex < 0 || endIndex >= GetLength() || startIndex > endIndex)
+            throw std::out_of_range("Invalid indices for subsequence");
+        auto result = std::make_unique<ArrayMutableSequence<T>>();
+        for (int i = startIndex; i <= endIndex; ++i)
+        {
+            result->AppendInPlace(Ref(i));
+        }
+        return result;
+    }
+
+    std::unique_ptr<ISequence<T>> Append(T item) override
+    {
+        auto copy = Snapshot();
+        copy->AppendInPlace(item);
+        return copy;
+    }
+
+    std::unique_ptr<ISequence<T>> Prepend(T item) override
+    {
+        auto copy = Snapshot();
+        copy->PrependInPlace(item);
+        return copy;
+    }
+
+    std::unique_ptr<ISequence<T>> InsertAt(T item, int index) override
+    {
+        auto copy = Snapshot();
+        copy->InsertAtInPlace(item, index);
+        return copy;
+    }
+
+    std::unique_ptr<ISequence<T>> Concat(const ISequence<T> *list) override
+    {
+        auto copy = Snapshot();
+        copy->ConcatInPlace(list);
+        return copy;
+    }
+};
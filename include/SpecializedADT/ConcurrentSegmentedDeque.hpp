@@ -0,0 +1,208 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// Thread-safe deque over a doubly linked list of fixed-size segments. The
+// head and the tail are guarded by separate locks, so producers at one end
+// do not contend with consumers at the other. While the deque holds fewer
+// than LOCK_BOTH_BELOW items the two ends may share or neighbour a segment,
+// so an operation then takes both locks (head first, then tail).
+template <typename T>
+class ConcurrentSegmentedDeque
+{
+private:
+    static constexpr int SEGMENT_SIZE = 64;
+    static constexpr long long LOCK_BOTH_BELOW = 4 * SEGMENT_SIZE;
+
+    struct Segment
+    {
+        alignas(T) unsigned char bytes[SEGMENT_SIZE][sizeof(T)];
+        Segment *prev = nullptr;
+        Segment *next = nullptr;
+
+        T *At(int index)
+        {
+            return std::launder(reinterpret_cast<T *>(bytes[index]));
+        }
+
+        void *RawAt(int index)
+        {
+            return bytes[index];
+        }
+    };
+
+    struct alignas(64) End
+    {
+        std::mutex lock;
+        Segment *segment = nullptr;
+        int index = 0;
+    };
+
+    End head;
+    End tail;
+    alignas(64) std::atomic<long long> size{0};
+
+    // Locks one end alone when the deque is large enough, both otherwise.
+    class Guard
+    {
+    private:
+        std::unique_lock<std::mutex> first;
+        std::unique_lock<std::mutex> second;
+
+    public:
+        Guard(ConcurrentSegmentedDeque &deque, bool atHead)
+        {
+            std::mutex &own = atHead ? deque.head.lock : deque.tail.lock;
+            if (deque.size.load() >= LOCK_BOTH_BELOW)
+            {
+                first = std::unique_lock<std::mutex>(own);
+                if (deque.size.load() >= LOCK_BOTH_BELOW)
+                    return;
+                first.unlock();
+            }
+            first = std::unique_lock<std::mutex>(deque.head.lock);
+            second = std::unique_lock<std::mutex>(deque.tail.lock);
+        }
+    };
+
+    template <typename U>
+    void PushHead(U &&item)
+    {
+        Guard guard(*this, true);
+        if (head.index == 0)
+        {
+            Segment *segment = new Segment;
+            segment->next = head.segment;
+            head.segment->prev = segment;
+            head.segment = segment;
+            head.index = SEGMENT_SIZE;
+        }
+        new (head.segment->RawAt(head.index - 1)) T(std::forward<U>(item));
+        --head.index;
+        size.fetch_add(1);
+    }
+
+    template <typename U>
+    void PushTail(U &&item)
+    {
+        Guard guard(*this, false);
+        if (tail.index == SEGMENT_SIZE)
+        {
+            Segment *segment = new Segment;
+            segment->prev = tail.segment;
+            tail.segment->next = segment;
+            tail.segment = segment;
+            tail.index = 0;
+        }
+        new (tail.segment->RawAt(tail.index)) T(std::forward<U>(item));
+        ++tail.index;
+        size.fetch_add(1);
+    }
+
+public:
+    ConcurrentSegmentedDeque()
+    {
+        Segment *segment = new Segment;
+        head.segment = tail.segment = segment;
+        head.index = tail.index = SEGMENT_SIZE / 2;
+    }
+
+    ConcurrentSegmentedDeque(const ConcurrentSegmentedDeque &) = delete;
+    ConcurrentSegmentedDeque &operator=(const ConcurrentSegmentedDeque &) = delete;
+
+    ~ConcurrentSegmentedDeque()
+    {
+        Segment *segment = head.segment;
+        int index = head.index;
+        for (long long i = size.load(); i > 0; --i)
+        {
+            if (index == SEGMENT_SIZE)
+            {
+                segment = segment->next;
+                index = 0;
+            }
+            segment->At(index++)->~T();
+        }
+        while (head.segment)
+        {
+            Segment *next = head.segment->next;
+            delete head.segment;
+            head.segment = next;
+        }
+    }
+
+    void PushFront(const T &item)
+    {
+        PushHead(item);
+    }
+
+    void PushFront(T &&item)
+    {
+        PushHead(std::move(item));
+    }
+
+    void PushBack(const T &item)
+    {
+        PushTail(item);
+    }
+
+    void PushBack(T &&item)
+    {
+        PushTail(std::move(item));
+    }
+
+    bool TryPopFront(T &out)
+    {
+        Guard guard(*this, true);
+        if (size.load() == 0)
+            return false;
+        if (head.index == SEGMENT_SIZE)
+        {
+            Segment *old = head.segment;
+            head.segment = old->next;
+            head.segment->prev = nullptr;
+            head.index = 0;
+            delete old;
+        }
+        T *item = head.segment->At(head.index);
+        out = std::move(*item);
+        item->~T();
+        ++head.index;
+        size.fetch_sub(1);
+        return true;
+    }
+
+    bool TryPopBack(T &out)
+    {
+        Guard guard(*this, false);
+        if (size.load() == 0)
+            return false;
+        if (tail.index == 0)
+        {
+            Segment *old = tail.segment;
+            tail.segment = old->prev;
+            tail.segment->next = nullptr;
+            tail.index = SEGMENT_SIZE;
+            delete old;
+        }
+        T *item = tail.segment->At(tail.index - 1);
+        out = std::move(*item);
+        item->~T();
+        --tail.index;
+        size.fetch_sub(1);
+        return true;
+    }
+
+    // Approximate under concurrent use.
+    int GetLength() const
+    {
+        return static_cast<int>(size.load());
+    }
+
+    bool IsEmpty() const
+    {
+        return size.load() == 0;
+    }
+};
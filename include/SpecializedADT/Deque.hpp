@@ -1,73 +1,70 @@
 #pragma once
-#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include "include/SpecializedADT/StoragePolicy.hpp"
 #include <stdexcept>
+#include <utility>
 
-template <typename T>
+template <typename T, typename Storage = RingStorage<T>>
 class Deque
 {
 private:
-    MutableSequence<T> *seq;
+    Storage storage;
 
 public:
-    Deque()
+    void PushFront(const T &item)
     {
-        seq = new ArrayMutableSequence<T>();
+        storage.PushFront(item);
     }
-    ~Deque()
+
+    void PushFront(T &&item)
     {
-        delete seq;
+        storage.PushFront(std::move(item));
     }
 
-    void PushFront(const T &item)
+    void PushBack(const T &item)
     {
-        seq->PrependInPlace(item);
+        storage.PushBack(item);
     }
 
-    void PushBack(const T &item)
+    void PushBack(T &&item)
     {
-        seq->AppendInPlace(item);
+        storage.PushBack(std::move(item));
     }
 
     T PopFront()
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
             throw std::out_of_range("Deque is empty");
-        T first = seq->GetFirst();
-        seq->RemoveAtInPlace(0);
-        return first;
+        return storage.PopFront();
     }
 
     T PopBack()
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
             throw std::out_of_range("Deque is empty");
-        int lastIndex = seq->GetLength() - 1;
-        T last = seq->GetLast();
-        seq->RemoveAtInPlace(lastIndex);
-        return last;
+        return storage.PopBack();
     }
 
-    T PeekFront() const
+    decltype(auto) PeekFront() const
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
             throw std::out_of_range("Deque is empty");
-        return seq->GetFirst();
+        return storage.Front();
     }
 
-    T PeekBack() const
+    decltype(auto) PeekBack() const
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
             throw std::out_of_range("Deque is empty");
-        return seq->GetLast();
+        return storage.Back();
     }
 
     int GetLength() const
     {
-        return seq->GetLength();
+        return storage.GetLength();
     }
 
     bool IsEmpty() const
     {
-        return seq->GetLength() == 0;
+        return storage.GetLength() == 0;
     }
 };
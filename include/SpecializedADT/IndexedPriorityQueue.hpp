@@ -0,0 +1,245 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+// Heap whose items can be re-prioritised or removed through the handle
+// returned by Enqueue. Handles stay valid until their item leaves the queue;
+// a slot's generation is bumped on reuse so stale handles are rejected.
+template <typename T, typename Compare = std::less<T>, int Arity = 4>
+class IndexedPriorityQueue
+{
+    static_assert(Arity >= 2, "IndexedPriorityQueue arity must be at least 2");
+
+public:
+    struct Handle
+    {
+        int slot = -1;
+        unsigned generation = 0;
+    };
+
+private:
+    struct Entry
+    {
+        T item;
+        int slot;
+    };
+
+    struct Slot
+    {
+        int position;
+        unsigned generation;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    Compare comp;
+
+    void Place(int index, Entry &&entry)
+    {
+        slots[entry.slot].position = index;
+        heap[index] = std::move(entry);
+    }
+
+    void SiftUp(int index)
+    {
+        Entry entry = std::move(heap[index]);
+        while (index > 0)
+        {
+            int parent = (index - 1) / Arity;
+            if (!comp(heap[parent].item, entry.item))
+                break;
+            Place(index, std::move(heap[parent]));
+            index = parent;
+        }
+        Place(index, std::move(entry));
+    }
+
+    void SiftDown(int index)
+    {
+        int size = static_cast<int>(heap.size());
+        Entry entry = std::move(heap[index]);
+        while (true)
+        {
+            int first = index * Arity + 1;
+            if (first >= size)
+                break;
+            int last = std::min(first + Arity, size);
+            int best = first;
+            for (int child = first + 1; child < last; ++child)
+            {
+                if (comp(heap[best].item, heap[child].item))
+                    best = child;
+            }
+            if (!comp(entry.item, heap[best].item))
+                break;
+            Place(index, std::move(heap[best]));
+            index = best;
+        }
+        Place(index, std::move(entry));
+    }
+
+    void Restore(int index)
+    {
+        if (index > 0 && comp(heap[(index - 1) / Arity].item, heap[index].item))
+            SiftUp(index);
+        else
+            SiftDown(index);
+    }
+
+    int AcquireSlot()
+    {
+        if (!freeSlots.empty())
+        {
+            int slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+        slots.push_back({-1, 0});
+        return static_cast<int>(slots.size()) - 1;
+    }
+
+    void ReleaseSlot(int slot)
+    {
+        slots[slot].position = -1;
+        ++slots[slot].generation;
+        freeSlots.push_back(slot);
+    }
+
+    int PositionOf(Handle handle) const
+    {
+        if (!Contains(handle))
+            throw std::out_of_range("Handle is not in the queue");
+        return slots[handle.slot].position;
+    }
+
+    Handle Push(T &&item)
+    {
+        int slot = AcquireSlot();
+        heap.push_back({std::move(item), slot});
+        SiftUp(static_cast<int>(heap.size()) - 1);
+        return {slot, slots[slot].generation};
+    }
+
+    T RemoveAt(int index)
+    {
+        int slot = heap[index].slot;
+        T item = std::move(heap[index].item);
+        int lastIndex = static_cast<int>(heap.size()) - 1;
+        if (index != lastIndex)
+        {
+            Place(index, std::move(heap.back()));
+            heap.pop_back();
+            Restore(index);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+        ReleaseSlot(slot);
+        return item;
+    }
+
+public:
+    IndexedPriorityQueue() = default;
+
+    explicit IndexedPriorityQueue(const Compare &comp) : comp(comp) {}
+
+    Handle Enqueue(const T &item)
+    {
+        T copy(item);
+        return Push(std::move(copy));
+    }
+
+    Handle Enqueue(T &&item)
+    {
+        return Push(std::move(item));
+    }
+
+    T Dequeue()
+    {
+        if (heap.empty())
+        {
+            throw std::out_of_range("IndexedPriorityQueue is empty");
+        }
+        return RemoveAt(0);
+    }
+
+    const T &Peek() const
+    {
+        if (heap.empty())
+        {
+            throw std::out_of_range("IndexedPriorityQueue is empty");
+        }
+        return heap.front().item;
+    }
+
+    Handle PeekHandle() const
+    {
+        if (heap.empty())
+        {
+            throw std::out_of_range("IndexedPriorityQueue is empty");
+        }
+        int slot = heap.front().slot;
+        return {slot, slots[slot].generation};
+    }
+
+    bool Contains(Handle handle) const
+    {
+        return handle.slot >= 0 && handle.slot < static_cast<int>(slots.size()) &&
+               slots[handle.slot].generation == handle.generation &&
+               slots[handle.slot].position >= 0;
+    }
+
+    const T &Get(Handle handle) const
+    {
+        return heap[PositionOf(handle)].item;
+    }
+
+    void UpdatePriority(Handle handle, const T &item)
+    {
+        int index = PositionOf(handle);
+        heap[index].item = item;
+        Restore(index);
+    }
+
+    void UpdatePriority(Handle handle, T &&item)
+    {
+        int index = PositionOf(handle);
+        heap[index].item = std::move(item);
+        Restore(index);
+    }
+
+    T Remove(Handle handle)
+    {
+        return RemoveAt(PositionOf(handle));
+    }
+
+    void Reserve(int capacity)
+    {
+        heap.reserve(capacity);
+        slots.reserve(capacity);
+    }
+
+    void Clear()
+    {
+        for (const Entry &entry : heap)
+        {
+            ReleaseSlot(entry.slot);
+        }
+        heap.clear();
+    }
+
+    int GetLength() const
+    {
+        return static_cast<int>(heap.size());
+    }
+
+    bool IsEmpty() const
+    {
+        return heap.empty();
+    }
+};
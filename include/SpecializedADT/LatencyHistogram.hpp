@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Histogram of non-negative integer values, laid out like HdrHistogram:
+// every power of two is split into the same number of linear sub-buckets,
+// so a recorded value is kept to within 1 / 2^precision of itself whatever
+// its magnitude. Record is a shift and an increment, the counts take
+// (65 - precision) * 2^precision slots, and histograms recorded on
+// different threads are combined with Merge.
+class LatencyHistogram
+{
+private:
+    int precision;
+    uint64_t subBuckets;
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    uint64_t maximum = 0;
+    double sum = 0;
+
+    static int HighestBit(uint64_t value)
+    {
+        return 63 - __builtin_clzll(value);
+    }
+
+    size_t IndexOf(uint64_t value) const
+    {
+        if (value < subBuckets)
+            return static_cast<size_t>(value);
+        int shift = HighestBit(value) - precision;
+        return static_cast<size_t>((static_cast<uint64_t>(shift) + 1) * subBuckets + (value >> shift) - subBuckets);
+    }
+
+    // Largest value that lands in bucket `index`.
+    uint64_t HighestIn(size_t index) const
+    {
+        if (index < subBuckets)
+            return index;
+        uint64_t shift = index / subBuckets - 1;
+        uint64_t lowest = (index % subBuckets + subBuckets) << shift;
+        return lowest + ((uint64_t(1) << shift) - 1);
+    }
+
+public:
+    explicit LatencyHistogram(int precision = 7) : precision(precision)
+    {
+        if (precision < 1 || precision > 16)
+            throw std::invalid_argument("Histogram precision must be between 1 and 16 bits");
+        subBuckets = uint64_t(1) << precision;
+        counts.resize(static_cast<size_t>(65 - precision) * subBuckets);
+    }
+
+    void Record(uint64_t value, uint64_t count = 1)
+    {
+        counts[IndexOf(value)] += count;
+        total += count;
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        sum += static_cast<double>(value) * static_cast<double>(count);
+    }
+
+    void Merge(const LatencyHistogram &other)
+    {
+        if (other.precision != precision)
+            throw std::invalid_argument("Histograms have different precision");
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+        sum += other.sum;
+    }
+
+    void Clear()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        minimum = std::numeric_limits<uint64_t>::max();
+        maximum = 0;
+        sum = 0;
+    }
+
+    // Value that `percentile` percent of the recorded values do not exceed,
+    // reported as the top of its bucket but never above the maximum.
+    uint64_t GetValueAtPercentile(double percentile) const
+    {
+        if (total == 0)
+            throw std::out_of_range("LatencyHistogram is empty");
+        percentile = std::clamp(percentile, 0.0, 100.0);
+        uint64_t rank = static_cast<uint64_t>(percentile / 100 * static_cast<double>(total) + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+                return std::min(HighestIn(i), maximum);
+        }
+        return maximum;
+    }
+
+    uint64_t GetCount() const
+    {
+        return total;
+    }
+
+    uint64_t GetMin() const
+    {
+        if (total == 0)
+            throw std::out_of_range("LatencyHistogram is empty");
+        return minimum;
+    }
+
+    uint64_t GetMax() const
+    {
+        if (total == 0)
+            throw std::out_of_range("LatencyHistogram is empty");
+        return maximum;
+    }
+
+    double GetMean() const
+    {
+        if (total == 0)
+            throw std::out_of_range("LatencyHistogram is empty");
+        return sum / static_cast<double>(total);
+    }
+};
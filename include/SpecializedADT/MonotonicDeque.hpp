@@ -0,0 +1,95 @@
+#pragma once
+#include "include/core/RingBuffer.hpp"
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+// Deque that keeps only the items that can still become the extreme of a
+// window: pushing an item drops every older item it beats, so the front is
+// the best item under Compare (the minimum for std::less). Each pushed item
+// gets a position; ExpireBefore drops items that slid out of the window.
+// Push and ExpireBefore are amortised O(1).
+template <typename T, typename Compare = std::less<T>>
+class MonotonicDeque
+{
+private:
+    struct Entry
+    {
+        long long position;
+        T item;
+    };
+
+    RingBuffer<Entry> entries;
+    Compare comp;
+    long long nextPosition = 0;
+
+    void DropBeaten(const T &item)
+    {
+        while (!entries.IsEmpty() && !comp(entries.Back().item, item))
+        {
+            entries.DropBack();
+        }
+    }
+
+public:
+    MonotonicDeque() = default;
+
+    explicit MonotonicDeque(const Compare &comp) : comp(comp) {}
+
+    long long Push(const T &item)
+    {
+        DropBeaten(item);
+        entries.EmplaceBack(Entry{nextPosition, item});
+        return nextPosition++;
+    }
+
+    long long Push(T &&item)
+    {
+        DropBeaten(item);
+        entries.EmplaceBack(Entry{nextPosition, std::move(item)});
+        return nextPosition++;
+    }
+
+    void ExpireBefore(long long position)
+    {
+        while (!entries.IsEmpty() && entries.Front().position < position)
+        {
+            entries.DropFront();
+        }
+    }
+
+    const T &Front() const
+    {
+        if (entries.IsEmpty())
+            throw std::out_of_range("MonotonicDeque is empty");
+        return entries.Front().item;
+    }
+
+    long long FrontPosition() const
+    {
+        if (entries.IsEmpty())
+            throw std::out_of_range("MonotonicDeque is empty");
+        return entries.Front().position;
+    }
+
+    long long GetNextPosition() const
+    {
+        return nextPosition;
+    }
+
+    void Clear()
+    {
+        entries.Clear();
+        nextPosition = 0;
+    }
+
+    int GetLength() const
+    {
+        return entries.GetLength();
+    }
+
+    bool IsEmpty() const
+    {
+        return entries.IsEmpty();
+    }
+};
@@ -0,0 +1,284 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Bounded multi-producer/multi-consumer queue (Vyukov). Every cell carries a
+// sequence number telling whether it is ready for the producer or the
+// consumer at a given position, so producers and consumers only contend on
+// their own position counter. The Try* calls never block; Enqueue/Dequeue
+// spin briefly and then park on a condition variable until woken or closed.
+// Close also sets the top bit of the enqueue position, so no producer can
+// claim a cell afterwards and consumers know exactly where the queue ends.
+template <typename T>
+class MpmcQueue
+{
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+    static constexpr int SPIN_LIMIT = 128;
+    static constexpr std::size_t CLOSED_BIT = ~(~std::size_t(0) >> 1);
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char bytes[sizeof(T)];
+
+        T *Item()
+        {
+            return std::launder(reinterpret_cast<T *>(bytes));
+        }
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> enqueuePos{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> dequeuePos{0};
+    alignas(CACHE_LINE) std::atomic<bool> closed{false};
+    std::atomic<int> waitingProducers{0};
+    std::atomic<int> waitingConsumers{0};
+    std::mutex parkMutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+    static std::intptr_t Distance(std::size_t sequence, std::size_t position)
+    {
+        return static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+    }
+
+    bool HasItems() const
+    {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        return Distance(cells[pos & mask].sequence.load(std::memory_order_acquire), pos + 1) >= 0;
+    }
+
+    bool HasSpace() const
+    {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed) & ~CLOSED_BIT;
+        return Distance(cells[pos & mask].sequence.load(std::memory_order_acquire), pos) >= 0;
+    }
+
+    // Pairs with the fetch_add in Park: either the waiter sees the new
+    // state when it re-checks under the lock, or we see it waiting here.
+    static void Wake(std::atomic<int> &waiting, std::mutex &mutex, std::condition_variable &condition)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_one();
+        }
+    }
+
+    template <typename Ready>
+    void Park(std::atomic<int> &waiting, std::condition_variable &condition, Ready ready)
+    {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        waiting.fetch_add(1);
+        condition.wait(lock, [&] { return ready() || closed.load(); });
+        waiting.fetch_sub(1);
+    }
+
+    template <typename... Args>
+    bool TryEmplaceOpen(Args &&...args)
+    {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            if (pos & CLOSED_BIT)
+                return false;
+            cell = &cells[pos & mask];
+            std::intptr_t diff = Distance(cell->sequence.load(std::memory_order_acquire), pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->bytes) T(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        Wake(waitingConsumers, parkMutex, notEmpty);
+        return true;
+    }
+
+public:
+    // Capacity is rounded up to a power of two (at least 2).
+    explicit MpmcQueue(int capacity)
+    {
+        if (capacity <= 0)
+            throw std::invalid_argument("Capacity must be positive");
+        std::size_t size = 2;
+        while (size < static_cast<std::size_t>(capacity))
+            size <<= 1;
+        mask = size - 1;
+        cells = std::make_unique<Cell[]>(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    ~MpmcQueue()
+    {
+        std::size_t head = dequeuePos.load(std::memory_order_relaxed);
+        std::size_t tail = enqueuePos.load(std::memory_order_relaxed) & ~CLOSED_BIT;
+        for (; head != tail; ++head)
+        {
+            Cell &cell = cells[head & mask];
+            if (cell.sequence.load(std::memory_order_relaxed) == head + 1)
+                cell.Item()->~T();
+        }
+    }
+
+    template <typename... Args>
+    bool TryEmplace(Args &&...args)
+    {
+        if (closed.load(std::memory_order_acquire))
+            return false;
+        return TryEmplaceOpen(std::forward<Args>(args)...);
+    }
+
+    bool TryEnqueue(const T &item)
+    {
+        return TryEmplace(item);
+    }
+
+    bool TryEnqueue(T &&item)
+    {
+        return TryEmplace(std::move(item));
+    }
+
+    bool TryDequeue(T &out)
+    {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            std::intptr_t diff = Distance(cell->sequence.load(std::memory_order_acquire), pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        T *item = cell->Item();
+        out = std::move(*item);
+        item->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        Wake(waitingProducers, parkMutex, notFull);
+        return true;
+    }
+
+    // Blocks while the queue is full. Returns false once the queue is closed.
+    bool Enqueue(T item)
+    {
+        for (int spin = 0; spin < SPIN_LIMIT; ++spin)
+        {
+            if (closed.load(std::memory_order_acquire))
+                return false;
+            if (TryEmplaceOpen(std::move(item)))
+                return true;
+            std::this_thread::yield();
+        }
+        while (true)
+        {
+            if (closed.load(std::memory_order_acquire))
+                return false;
+            if (TryEmplaceOpen(std::move(item)))
+                return true;
+            Park(waitingProducers, notFull, [&] { return HasSpace(); });
+        }
+    }
+
+    // Blocks while the queue is empty. Returns false only when the queue has
+    // been closed and everything enqueued before Close has been drained.
+    bool Dequeue(T &out)
+    {
+        for (int spin = 0; spin < SPIN_LIMIT; ++spin)
+        {
+            if (TryDequeue(out))
+                return true;
+            std::this_thread::yield();
+        }
+        while (true)
+        {
+            if (TryDequeue(out))
+                return true;
+            if (closed.load(std::memory_order_acquire))
+                break;
+            Park(waitingConsumers, notEmpty, [&] { return HasItems(); });
+        }
+        // No cell can be claimed past `tail` any more, but one below it may
+        // still be waiting for its producer to publish it.
+        std::size_t tail = enqueuePos.load(std::memory_order_acquire) & ~CLOSED_BIT;
+        while (Distance(dequeuePos.load(std::memory_order_relaxed), tail) < 0)
+        {
+            if (TryDequeue(out))
+                return true;
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    // Rejects further enqueues and wakes every parked thread. Items already
+    // in the queue can still be dequeued.
+    void Close()
+    {
+        enqueuePos.fetch_or(CLOSED_BIT, std::memory_order_acq_rel);
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMutex);
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    bool IsClosed() const
+    {
+        return closed.load(std::memory_order_acquire);
+    }
+
+    // Approximate under concurrent use.
+    int GetLength() const
+    {
+        std::size_t head = dequeuePos.load(std::memory_order_acquire);
+        std::size_t tail = enqueuePos.load(std::memory_order_acquire) & ~CLOSED_BIT;
+        return tail > head ? static_cast<int>(tail - head) : 0;
+    }
+
+    bool IsEmpty() const
+    {
+        return GetLength() == 0;
+    }
+
+    int GetCapacity() const
+    {
+        return static_cast<int>(mask + 1);
+    }
+};
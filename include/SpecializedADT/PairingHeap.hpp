@@ -0,0 +1,242 @@
+#pragma once
+#include "include/core/NodePool.hpp"
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+// Meldable heap: Enqueue and Meld are O(1), Dequeue is amortised O(log n).
+// Nodes come from a NodePool; heaps that share a pool meld by linking two
+// roots, while melding across pools has to move every node (O(n)).
+// A default-constructed heap has a pool of its own and can move between
+// threads. Heaps that should meld in O(1) are given one pool, for example
+// ThreadPool(); NodePool is not thread-safe, so all heaps on a pool must be
+// used from one thread at a time.
+template <typename T, typename Compare = std::less<T>>
+class PairingHeap
+{
+private:
+    struct Node
+    {
+        T item;
+        Node *child = nullptr;
+        Node *sibling = nullptr;
+
+        template <typename U>
+        explicit Node(U &&item) : item(std::forward<U>(item)) {}
+    };
+
+public:
+    using Pool = NodePool<Node>;
+
+private:
+    std::shared_ptr<Pool> pool;
+    Node *root = nullptr;
+    int size = 0;
+    Compare comp;
+
+    Node *Link(Node *first, Node *second)
+    {
+        if (!first)
+            return second;
+        if (!second)
+            return first;
+        if (comp(first->item, second->item))
+            std::swap(first, second);
+        second->sibling = first->child;
+        first->child = second;
+        return first;
+    }
+
+    // Standard two-pass pairing: link siblings in pairs left to right, then
+    // fold the pairs right to left. The first pass reuses sibling pointers
+    // as a stack so no extra memory is needed.
+    Node *MergePairs(Node *first)
+    {
+        Node *pairs = nullptr;
+        while (first)
+        {
+            Node *second = first->sibling;
+            Node *next = second ? second->sibling : nullptr;
+            first->sibling = nullptr;
+            if (second)
+                second->sibling = nullptr;
+            Node *linked = Link(first, second);
+            linked->sibling = pairs;
+            pairs = linked;
+            first = next;
+        }
+
+        Node *result = nullptr;
+        while (pairs)
+        {
+            Node *next = pairs->sibling;
+            pairs->sibling = nullptr;
+            result = Link(result, pairs);
+            pairs = next;
+        }
+        return result;
+    }
+
+    template <typename Visit>
+    static void ForEachNode(Node *top, Visit visit)
+    {
+        std::vector<Node *> pending;
+        if (top)
+            pending.push_back(top);
+        while (!pending.empty())
+        {
+            Node *node = pending.back();
+            pending.pop_back();
+            if (node->child)
+                pending.push_back(node->child);
+            if (node->sibling)
+                pending.push_back(node->sibling);
+            visit(node);
+        }
+    }
+
+    template <typename U>
+    void Push(U &&item)
+    {
+        Node *node = pool->Allocate(std::forward<U>(item));
+        root = Link(root, node);
+        ++size;
+    }
+
+public:
+    // The calling thread's shared pool, for heaps that meld with each other
+    // and stay on this thread.
+    static const std::shared_ptr<Pool> &ThreadPool()
+    {
+        static thread_local std::shared_ptr<Pool> shared = std::make_shared<Pool>();
+        return shared;
+    }
+
+    explicit PairingHeap(const Compare &comp = Compare()) : pool(std::make_shared<Pool>()), comp(comp) {}
+
+    explicit PairingHeap(std::shared_ptr<Pool> pool, const Compare &comp = Compare())
+        : pool(std::move(pool)), comp(comp)
+    {
+        if (!this->pool)
+            throw std::invalid_argument("Pool cannot be null");
+    }
+
+    PairingHeap(const PairingHeap &) = delete;
+    PairingHeap &operator=(const PairingHeap &) = delete;
+
+    PairingHeap(PairingHeap &&other) noexcept
+        : pool(other.pool), root(other.root), size(other.size), comp(other.comp)
+    {
+        other.root = nullptr;
+        other.size = 0;
+    }
+
+    PairingHeap &operator=(PairingHeap &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Clear();
+            pool = other.pool;
+            root = other.root;
+            size = other.size;
+            comp = other.comp;
+            other.root = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    ~PairingHeap()
+    {
+        Clear();
+    }
+
+    void Enqueue(const T &item)
+    {
+        Push(item);
+    }
+
+    void Enqueue(T &&item)
+    {
+        Push(std::move(item));
+    }
+
+    T Dequeue()
+    {
+        if (!root)
+        {
+            throw std::out_of_range("PairingHeap is empty");
+        }
+        Node *top = root;
+        T item = std::move(top->item);
+        root = MergePairs(top->child);
+        pool->Release(top);
+        --size;
+        return item;
+    }
+
+    const T &Peek() const
+    {
+        if (!root)
+        {
+            throw std::out_of_range("PairingHeap is empty");
+        }
+        return root->item;
+    }
+
+    // Takes every element out of other, leaving it empty. O(1) when both
+    // heaps use the same pool, O(n) in other's size when they do not.
+    void Meld(PairingHeap &other)
+    {
+        if (this == &other || !other.root)
+            return;
+
+        if (pool == other.pool)
+        {
+            root = Link(root, other.root);
+        }
+        else
+        {
+            Pool &source = *other.pool;
+            ForEachNode(other.root, [&](Node *node) {
+                Node *copy = pool->Allocate(std::move(node->item));
+                root = Link(root, copy);
+                source.Release(node);
+            });
+        }
+        size += other.size;
+        other.root = nullptr;
+        other.size = 0;
+    }
+
+    void Meld(PairingHeap &&other)
+    {
+        Meld(other);
+    }
+
+    const std::shared_ptr<Pool> &GetPool() const
+    {
+        return pool;
+    }
+
+    void Clear()
+    {
+        if (!pool)
+            return;
+        ForEachNode(root, [&](Node *node) { pool->Release(node); });
+        root = nullptr;
+        size = 0;
+    }
+
+    int GetLength() const
+    {
+        return size;
+    }
+
+    bool IsEmpty() const
+    {
+        return size == 0;
+    }
+};
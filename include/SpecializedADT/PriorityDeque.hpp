@@ -1,114 +1,462 @@
 #pragma once
-#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <utility>
 #include <stdexcept>
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>, int Arity = 4>
 class PriorityQueue
 {
+    static_assert(Arity >= 2, "PriorityQueue arity must be at least 2");
+
 private:
-    MutableSequence<T> *seq;
+    std::vector<T> heap;
+    Compare comp;
 
-    void BubbleUp(int index)
+    void SiftUp(int index)
     {
+        T item = std::move(heap[index]);
         while (index > 0)
         {
-            int parent = (index - 1) / 2;
-            if (seq->Get(parent) < seq->Get(index))
-            {
-                std::swap((*seq)[parent], (*seq)[index]);
-                index = parent;
-            }
-            else
-            {
+            int parent = (index - 1) / Arity;
+            if (!comp(heap[parent], item))
                 break;
-            }
+            heap[index] = std::move(heap[parent]);
+            index = parent;
         }
+        heap[index] = std::move(item);
     }
 
-    void BubbleDown(int index)
+    void SiftDown(int index)
     {
-        int size = seq->GetLength();
+        int size = static_cast<int>(heap.size());
+        T item = std::move(heap[index]);
         while (true)
         {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int largest = index;
-
-            if (left < size && seq->Get(left) > seq->Get(largest))
-                largest = left;
-            if (right < size && seq->Get(right) > seq->Get(largest))
-                largest = right;
-
-            if (largest != index)
+            int first = index * Arity + 1;
+            if (first >= size)
+                break;
+            int last = std::min(first + Arity, size);
+            int best = first;
+            for (int child = first + 1; child < last; ++child)
             {
-                std::swap((*seq)[index], (*seq)[largest]);
-                index = largest;
+                if (comp(heap[best], heap[child]))
+                    best = child;
             }
-            else
-            {
+            if (!comp(item, heap[best]))
                 break;
-            }
+            heap[index] = std::move(heap[best]);
+            index = best;
+        }
+        heap[index] = std::move(item);
+    }
+
+    // Floyd's bottom-up construction: O(n) instead of n sift-ups.
+    void Heapify()
+    {
+        int size = static_cast<int>(heap.size());
+        if (size < 2)
+            return;
+        for (int i = (size - 2) / Arity; i >= 0; --i)
+        {
+            SiftDown(i);
         }
     }
 
 public:
-    PriorityQueue()
+    PriorityQueue() = default;
+
+    explicit PriorityQueue(const Compare &comp) : comp(comp) {}
+
+    PriorityQueue(const T *items, int count, const Compare &comp = Compare())
+        : comp(comp)
     {
-        seq = new ArrayMutableSequence<T>();
+        if (count < 0)
+            throw std::invalid_argument("Count cannot be negative");
+        heap.assign(items, items + count);
+        Heapify();
     }
-    ~PriorityQueue()
+
+    PriorityQueue(std::vector<T> items, const Compare &comp = Compare())
+        : heap(std::move(items)), comp(comp)
     {
-        delete seq;
+        Heapify();
     }
 
     void Enqueue(const T &item)
     {
-        seq->AppendInPlace(item);
-        BubbleUp(seq->GetLength() - 1);
+        heap.push_back(item);
+        SiftUp(static_cast<int>(heap.size()) - 1);
     }
 
     void Enqueue(T &&item)
     {
-        seq->AppendInPlace(std::move(item));
-        BubbleUp(seq->GetLength() - 1);
+        heap.push_back(std::move(item));
+        SiftUp(static_cast<int>(heap.size()) - 1);
+    }
+
+    template <typename... Args>
+    void Emplace(Args &&...args)
+    {
+        heap.emplace_back(std::forward<Args>(args)...);
+        SiftUp(static_cast<int>(heap.size()) - 1);
+    }
+
+    template <typename InputIt>
+    void PushRange(InputIt first, InputIt last)
+    {
+        int oldSize = static_cast<int>(heap.size());
+        heap.insert(heap.end(), first, last);
+        int size = static_cast<int>(heap.size());
+
+        if (size - oldSize > oldSize)
+        {
+            Heapify();
+            return;
+        }
+        for (int i = oldSize; i < size; ++i)
+        {
+            SiftUp(i);
+        }
     }
 
     T Dequeue()
     {
-        if (seq->GetLength() == 0)
+        if (heap.empty())
         {
             throw std::out_of_range("PriorityQueue is empty");
         }
 
-        T top = seq->GetFirst(); 
+        T top = std::move(heap.front());
+        if (heap.size() > 1)
+        {
+            heap.front() = std::move(heap.back());
+            heap.pop_back();
+            SiftDown(0);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+        return top;
+    }
 
-        (*seq)[0] = seq->Get(seq->GetLength() - 1);
-        seq->RemoveAtInPlace(seq->GetLength() - 1);
+    const T &Peek() const
+    {
+        if (heap.empty())
+        {
+            throw std::out_of_range("PriorityQueue is empty");
+        }
+        return heap.front();
+    }
 
-        if (!IsEmpty())
+    void Reserve(int capacity)
+    {
+        heap.reserve(capacity);
+    }
+
+    void Clear()
+    {
+        heap.clear();
+    }
+
+    int GetLength() const
+    {
+        return static_cast<int>(heap.size());
+    }
+
+    bool IsEmpty() const
+    {
+        return heap.empty();
+    }
+};
+
+// Min-max heap: even levels are ordered by Compare towards the minimum,
+// odd levels towards the maximum, so both ends are reachable in O(1).
+template <typename T, typename Compare = std::less<T>>
+class PriorityDeque
+{
+private:
+    std::vector<T> heap;
+    Compare comp;
+    int capacity = 0;
+
+    static bool IsMinLevel(int index)
+    {
+        int level = 31 - __builtin_clz(static_cast<unsigned>(index) + 1);
+        return (level & 1) == 0;
+    }
+
+    template <bool IsMax>
+    bool Before(const T &a, const T &b) const
+    {
+        return IsMax ? comp(b, a) : comp(a, b);
+    }
+
+    template <bool IsMax>
+    void BubbleUp(int index)
+    {
+        while (index > 2)
         {
-            BubbleDown(0);
+            int grandparent = ((index - 1) / 2 - 1) / 2;
+            if (!Before<IsMax>(heap[index], heap[grandparent]))
+                break;
+            std::swap(heap[index], heap[grandparent]);
+            index = grandparent;
         }
+    }
 
-        return top;
+    void TrickleUp(int index)
+    {
+        if (index == 0)
+            return;
+        int parent = (index - 1) / 2;
+        if (IsMinLevel(index))
+        {
+            if (comp(heap[parent], heap[index]))
+            {
+                std::swap(heap[parent], heap[index]);
+                BubbleUp<true>(parent);
+            }
+            else
+            {
+                BubbleUp<false>(index);
+            }
+        }
+        else
+        {
+            if (comp(heap[index], heap[parent]))
+            {
+                std::swap(heap[parent], heap[index]);
+                BubbleUp<false>(parent);
+            }
+            else
+            {
+                BubbleUp<true>(index);
+            }
+        }
     }
 
-    T Peek() const
+    template <bool IsMax>
+    void TrickleDown(int index)
     {
-        if (seq->GetLength() == 0)
+        int size = static_cast<int>(heap.size());
+        while (true)
         {
-            throw std::out_of_range("PriorityQueue is empty");
+            int child = 2 * index + 1;
+            if (child >= size)
+                break;
+
+            int best = child;
+            if (child + 1 < size && Before<IsMax>(heap[child + 1], heap[best]))
+                best = child + 1;
+            int grandchild = 2 * child + 1;
+            int lastGrandchild = std::min(grandchild + 4, size);
+            for (int g = grandchild; g < lastGrandchild; ++g)
+            {
+                if (Before<IsMax>(heap[g], heap[best]))
+                    best = g;
+            }
+
+            if (!Before<IsMax>(heap[best], heap[index]))
+                break;
+            std::swap(heap[best], heap[index]);
+            if (best < grandchild)
+                break;
+
+            int parent = (best - 1) / 2;
+            if (Before<IsMax>(heap[parent], heap[best]))
+                std::swap(heap[parent], heap[best]);
+            index = best;
+        }
+    }
+
+    void TrickleDown(int index)
+    {
+        if (IsMinLevel(index))
+            TrickleDown<false>(index);
+        else
+            TrickleDown<true>(index);
+    }
+
+    void Heapify()
+    {
+        for (int i = static_cast<int>(heap.size()) / 2 - 1; i >= 0; --i)
+        {
+            TrickleDown(i);
+        }
+    }
+
+    int MaxIndex() const
+    {
+        int size = static_cast<int>(heap.size());
+        if (size == 1)
+            return 0;
+        if (size == 2 || !comp(heap[1], heap[2]))
+            return 1;
+        return 2;
+    }
+
+    T RemoveAt(int index)
+    {
+        T item = std::move(heap[index]);
+        if (index != static_cast<int>(heap.size()) - 1)
+        {
+            heap[index] = std::move(heap.back());
+            heap.pop_back();
+            TrickleDown(index);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+        return item;
+    }
+
+    bool Push(T &&item)
+    {
+        if (capacity > 0 && static_cast<int>(heap.size()) >= capacity)
+        {
+            if (!comp(heap.front(), item))
+                return false;
+            heap.front() = std::move(item);
+            TrickleDown(0);
+            return true;
+        }
+        heap.push_back(std::move(item));
+        TrickleUp(static_cast<int>(heap.size()) - 1);
+        return true;
+    }
+
+    void EvictOverflow()
+    {
+        while (capacity > 0 && static_cast<int>(heap.size()) > capacity)
+        {
+            RemoveAt(0);
+        }
+    }
+
+public:
+    PriorityDeque() = default;
+
+    explicit PriorityDeque(int capacity, const Compare &comp = Compare())
+        : comp(comp)
+    {
+        SetCapacity(capacity);
+    }
+
+    PriorityDeque(const T *items, int count, const Compare &comp = Compare())
+        : comp(comp)
+    {
+        if (count < 0)
+            throw std::invalid_argument("Count cannot be negative");
+        heap.assign(items, items + count);
+        Heapify();
+    }
+
+    PriorityDeque(std::vector<T> items, const Compare &comp = Compare())
+        : heap(std::move(items)), comp(comp)
+    {
+        Heapify();
+    }
+
+    // A positive capacity turns the deque into a bounded top-K buffer:
+    // once full, a new item replaces the minimum or is rejected.
+    void SetCapacity(int newCapacity)
+    {
+        if (newCapacity < 0)
+            throw std::invalid_argument("Capacity cannot be negative");
+        capacity = newCapacity;
+        EvictOverflow();
+    }
+
+    int GetCapacity() const
+    {
+        return capacity;
+    }
+
+    bool Enqueue(const T &item)
+    {
+        T copy(item);
+        return Push(std::move(copy));
+    }
+
+    bool Enqueue(T &&item)
+    {
+        return Push(std::move(item));
+    }
+
+    template <typename InputIt>
+    void PushRange(InputIt first, InputIt last)
+    {
+        int oldSize = static_cast<int>(heap.size());
+        if (capacity == 0)
+        {
+            heap.insert(heap.end(), first, last);
+            int size = static_cast<int>(heap.size());
+            if (size - oldSize > oldSize)
+            {
+                Heapify();
+                return;
+            }
+            for (int i = oldSize; i < size; ++i)
+            {
+                TrickleUp(i);
+            }
+            return;
+        }
+        for (; first != last; ++first)
+        {
+            Enqueue(*first);
         }
-        return seq->GetFirst();
+    }
+
+    const T &PeekMin() const
+    {
+        if (heap.empty())
+            throw std::out_of_range("PriorityDeque is empty");
+        return heap.front();
+    }
+
+    const T &PeekMax() const
+    {
+        if (heap.empty())
+            throw std::out_of_range("PriorityDeque is empty");
+        return heap[MaxIndex()];
+    }
+
+    T PopMin()
+    {
+        if (heap.empty())
+            throw std::out_of_range("PriorityDeque is empty");
+        return RemoveAt(0);
+    }
+
+    T PopMax()
+    {
+        if (heap.empty())
+            throw std::out_of_range("PriorityDeque is empty");
+        return RemoveAt(MaxIndex());
+    }
+
+    void Reserve(int count)
+    {
+        heap.reserve(count);
+    }
+
+    void Clear()
+    {
+        heap.clear();
     }
 
     int GetLength() const
     {
-        return seq->GetLength();
+        return static_cast<int>(heap.size());
     }
 
     bool IsEmpty() const
     {
-        return seq->GetLength() == 0;
+        return heap.empty();
     }
 };
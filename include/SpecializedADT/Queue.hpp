@@ -1,54 +1,45 @@
 #pragma once
-#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include "include/SpecializedADT/StoragePolicy.hpp"
 #include <stdexcept>
+#include <utility>
 
-template <typename T>
+template <typename T, typename Storage = RingStorage<T>>
 class Queue
 {
 private:
-    MutableSequence<T> *seq;
+    Storage storage;
 
 public:
-    Queue()
-    {
-        seq = new ArrayMutableSequence<T>();
-    }
-    ~Queue()
-    {
-        delete seq;
-    }
     void Enqueue(const T &item)
     {
-        seq->AppendInPlace(item);
+        storage.PushBack(item);
     }
     void Enqueue(T &&item)
     {
-        seq->AppendInPlace(std::move(item));
+        storage.PushBack(std::move(item));
     }
     T Dequeue()
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
         {
             throw std::out_of_range("Queue is empty");
         }
-        T first = seq->GetFirst();
-        seq->RemoveAtInPlace(0);
-        return first;
+        return storage.PopFront();
     }
-    T Peek() const
+    decltype(auto) Peek() const
     {
-        if (seq->GetLength() == 0)
+        if (storage.GetLength() == 0)
         {
             throw std::out_of_range("Queue is empty");
         }
-        return seq->GetFirst();
+        return storage.Front();
     }
     int GetLength() const
     {
-        return seq->GetLength();
+        return storage.GetLength();
     }
     bool IsEmpty() const
     {
-        return seq->GetLength() == 0;
+        return storage.GetLength() == 0;
     }
 };
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+// Min-heap for unsigned integer keys extracted in non-decreasing order
+// (event timestamps, Dijkstra distances). A key may never be smaller than
+// the last key taken out; in exchange each item moves between buckets at
+// most once per bit of the key, with no comparisons between items.
+template <typename Key, typename Value>
+class RadixHeap
+{
+    static_assert(std::is_unsigned<Key>::value, "RadixHeap keys must be unsigned integers");
+
+private:
+    static constexpr int BUCKET_COUNT = sizeof(Key) * 8 + 1;
+
+    std::vector<std::pair<Key, Value>> buckets[BUCKET_COUNT];
+    // Buckets are relative to `last`; Peek may raise it above `extracted`.
+    Key last = 0;
+    Key extracted = 0;
+    int size = 0;
+
+    static int BucketOf(Key key, Key last)
+    {
+        unsigned long long diff = static_cast<unsigned long long>(key ^ last);
+        return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+    }
+
+    void Pull()
+    {
+        if (!buckets[0].empty())
+            return;
+
+        int index = 1;
+        while (buckets[index].empty())
+            ++index;
+
+        std::vector<std::pair<Key, Value>> &source = buckets[index];
+        Key newLast = source.front().first;
+        for (const auto &entry : source)
+        {
+            if (entry.first < newLast)
+                newLast = entry.first;
+        }
+        last = newLast;
+        for (auto &entry : source)
+        {
+            buckets[BucketOf(entry.first, last)].push_back(std::move(entry));
+        }
+        source.clear();
+    }
+
+    // Returns the bucket for `key`. A key below the base but not below the
+    // last extracted one lowers the base to it: every held key is at least
+    // the old base, so only the buckets under the old base's new bucket
+    // change, and they merge into it.
+    int Place(Key key)
+    {
+        if (key < extracted)
+            throw std::invalid_argument("RadixHeap key is below the last extracted key");
+        if (key < last)
+        {
+            int target = BucketOf(last, key);
+            for (int index = 0; index < target; ++index)
+            {
+                for (auto &entry : buckets[index])
+                {
+                    buckets[target].push_back(std::move(entry));
+                }
+                buckets[index].clear();
+            }
+            last = key;
+        }
+        return BucketOf(key, last);
+    }
+
+public:
+    void Enqueue(Key key, const Value &value)
+    {
+        buckets[Place(key)].emplace_back(key, value);
+        ++size;
+    }
+
+    void Enqueue(Key key, Value &&value)
+    {
+        buckets[Place(key)].emplace_back(key, std::move(value));
+        ++size;
+    }
+
+    std::pair<Key, Value> Dequeue()
+    {
+        if (size == 0)
+        {
+            throw std::out_of_range("RadixHeap is empty");
+        }
+        Pull();
+        std::pair<Key, Value> top = std::move(buckets[0].back());
+        buckets[0].pop_back();
+        --size;
+        extracted = top.first;
+        return top;
+    }
+
+    const std::pair<Key, Value> &Peek()
+    {
+        if (size == 0)
+        {
+            throw std::out_of_range("RadixHeap is empty");
+        }
+        Pull();
+        return buckets[0].back();
+    }
+
+    Key GetLastKey() const
+    {
+        return extracted;
+    }
+
+    int GetLength() const
+    {
+        return size;
+    }
+
+    bool IsEmpty() const
+    {
+        return size == 0;
+    }
+};
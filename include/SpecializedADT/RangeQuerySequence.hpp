@@ -0,0 +1,175 @@
+#pragma once
+#include "include/ISequence.hpp"
+#include "include/Muttable/MutableSequence.hpp"
+#include "include/core/SegmentTree.hpp"
+#include "include/core/FenwickTree.hpp"
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Chooses the index behind RangeQuerySequence: a segment tree for any
+// associative Op, a Fenwick tree when Op is addition.
+template <typename T, typename Op>
+struct RangeIndex
+{
+    using Type = SegmentTree<T, Op>;
+};
+
+template <typename T>
+struct RangeIndex<T, std::plus<T>>
+{
+    using Type = FenwickTree<T>;
+};
+
+// Array sequence that keeps a reduction index over its items, so
+// RangeReduce and point Set are O(log n) instead of a scan. Appending is
+// amortised O(log n); inserting or removing elsewhere rebuilds the index
+// in O(n), the same order as shifting an array.
+template <typename T, typename Op = std::plus<T>>
+class RangeQuerySequence : public MutableSequence<T>
+{
+private:
+    typename RangeIndex<T, Op>::Type index;
+    Op op;
+
+    void CheckIndex(int position) const
+    {
+        if (position < 0 || position >= index.GetLength())
+            throw std::out_of_range("Index out of range");
+    }
+
+public:
+    explicit RangeQuerySequence(const Op &op = Op()) : index(op), op(op) {}
+
+    RangeQuerySequence(const T *items, int count, const Op &op = Op()) : index(op), op(op)
+    {
+        if (count < 0)
+            throw std::invalid_argument("Count cannot be negative");
+        index.Assign(std::vector<T>(items, items + count));
+    }
+
+    T GetFirst() const override
+    {
+        if (index.GetLength() == 0)
+            throw std::out_of_range("Sequence is empty");
+        return index.Get(0);
+    }
+
+    T GetLast() const override
+    {
+        if (index.GetLength() == 0)
+            throw std::out_of_range("Sequence is empty");
+        return index.Get(index.GetLength() - 1);
+    }
+
+    T Get(int position) const override
+    {
+        CheckIndex(position);
+        return index.Get(position);
+    }
+
+    int GetLength() const override
+    {
+        return index.GetLength();
+    }
+
+    void Set(int position, const T &item)
+    {
+        CheckIndex(position);
+        index.Set(position, item);
+    }
+
+    // Reduction of the items from startIndex to endIndex inclusive, the
+    // same bounds as GetSubsequence.
+    T RangeReduce(int startIndex, int endIndex) const
+    {
+        if (startIndex < 0 || endIndex >= GetLength() || startIndex > endIndex)
+            throw std::out_of_range("Invalid indices for range");
+        return index.Query(startIndex, endIndex + 1);
+    }
+
+    T Reduce() const
+    {
+        if (index.GetLength() == 0)
+            throw std::out_of_range("Sequence is empty");
+        return index.Total();
+    }
+
+    std::unique_ptr<ISequence<T>> GetSubsequence(int startIndex, int endIndex) const override
+    {
+        if (startIndex < 0 || endIndex >= GetLength() || startIndex > endIndex)
+            throw std::out_of_range("Invalid indices for subsequence");
+        std::vector<T> items = index.ToVector();
+        return std::make_unique<RangeQuerySequence<T, Op>>(items.data() + startIndex, endIndex - startIndex + 1, op);
+    }
+
+    std::unique_ptr<ISequence<T>> Append(T item) override
+    {
+        auto newSeq = std::make_unique<RangeQuerySequence<T, Op>>(*this);
+        newSeq->AppendInPlace(item);
+        return newSeq;
+    }
+
+    std::unique_ptr<ISequence<T>> Prepend(T item) override
+    {
+        auto newSeq = std::make_unique<RangeQuerySequence<T, Op>>(*this);
+        newSeq->PrependInPlace(item);
+        return newSeq;
+    }
+
+    std::unique_ptr<ISequence<T>> InsertAt(T item, int position) override
+    {
+        auto newSeq = std::make_unique<RangeQuerySequence<T, Op>>(*this);
+        newSeq->InsertAtInPlace(item, position);
+        return newSeq;
+    }
+
+    std::unique_ptr<ISequence<T>> Concat(const ISequence<T> *list) override
+    {
+        auto newSeq = std::make_unique<RangeQuerySequence<T, Op>>(*this);
+        newSeq->ConcatInPlace(list);
+        return newSeq;
+    }
+
+    void AppendInPlace(T item) override
+    {
+        index.PushBack(item);
+    }
+
+    void PrependInPlace(T item) override
+    {
+        InsertAtInPlace(item, 0);
+    }
+
+    void InsertAtInPlace(T item, int position) override
+    {
+        if (position < 0 || position > GetLength())
+            throw std::out_of_range("Invalid index");
+        if (position == GetLength())
+        {
+            index.PushBack(item);
+            return;
+        }
+        std::vector<T> items = index.ToVector();
+        items.insert(items.begin() + position, item);
+        index.Assign(items);
+    }
+
+    void ConcatInPlace(const ISequence<T> *list) override
+    {
+        int listSize = list->GetLength();
+        for (int i = 0; i < listSize; ++i)
+        {
+            index.PushBack(list->Get(i));
+        }
+    }
+
+    void RemoveAtInPlace(int position) override
+    {
+        CheckIndex(position);
+        std::vector<T> items = index.ToVector();
+        items.erase(items.begin() + position);
+        index.Assign(items);
+    }
+};
@@ -0,0 +1,426 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Append-only record log on disk, split into fixed-size segment files named
+// after the offset of their first record. Each segment is mapped with mmap:
+// appends are a memcpy into the mapping and reads are string_views into it,
+// so nothing is copied on either path and the kernel's page cache decides
+// which parts stay resident. A record is a 4-byte header holding its length
+// plus one, followed by the payload; the header is written after the payload
+// and a zero header marks the end of a segment, so a log reopened after a
+// crash stops at the last complete record. Every segment keeps a sparse
+// index with one entry per indexInterval bytes, which bounds the scan a
+// random read has to do. Single writer; readers must not race with appends.
+class SegmentLog
+{
+public:
+    struct Options
+    {
+        std::string directory;
+        // Size of each segment file. A record larger than this gets a
+        // segment of its own.
+        size_t segmentBytes = 64 * 1024 * 1024;
+        size_t indexInterval = 4096;
+        // Oldest segments are deleted once there are more than this many;
+        // zero keeps everything.
+        int maxSegments = 0;
+    };
+
+private:
+    using Header = uint32_t;
+    static constexpr size_t HEADER_BYTES = sizeof(Header);
+
+    struct IndexEntry
+    {
+        long long offset;
+        size_t position;
+    };
+
+    class Segment
+    {
+    private:
+        int fd = -1;
+        char *data = nullptr;
+        // Length of the mapping; Seal shrinks capacity but not the mapping.
+        size_t mapped = 0;
+        size_t capacity = 0;
+
+        void Map(size_t length)
+        {
+            void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "mmap " + path);
+            data = static_cast<char *>(mapping);
+            mapped = length;
+            capacity = length;
+        }
+
+    public:
+        std::string path;
+        long long baseOffset;
+        long long count = 0;
+        size_t used = 0;
+        size_t lastIndexed = 0;
+        std::vector<IndexEntry> index;
+
+        Segment(std::string path, long long baseOffset) : path(std::move(path)), baseOffset(baseOffset) {}
+
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+
+        ~Segment()
+        {
+            Close();
+        }
+
+        // Creates the file and maps `length` bytes of it for appending.
+        void Create(size_t length)
+        {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+            // Reserve the blocks up front: a store into a hole that the file
+            // system cannot back raises SIGBUS rather than returning ENOSPC.
+            int error = posix_fallocate(fd, 0, static_cast<off_t>(length));
+            if (error == EOPNOTSUPP || error == EINVAL)
+                error = ftruncate(fd, static_cast<off_t>(length)) < 0 ? errno : 0;
+            if (error != 0)
+                throw std::system_error(error, std::generic_category(), "fallocate " + path);
+            Map(length);
+        }
+
+        // Maps an existing file and returns its size; the caller scans it.
+        size_t Open()
+        {
+            fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+            struct stat info;
+            if (fstat(fd, &info) < 0)
+                throw std::system_error(errno, std::generic_category(), "fstat " + path);
+            if (info.st_size > 0)
+                Map(static_cast<size_t>(info.st_size));
+            return capacity;
+        }
+
+        // Starts write-back and gives the unused tail back to the file system.
+        void Seal()
+        {
+            if (data && used < capacity)
+            {
+                msync(data, capacity, MS_ASYNC);
+                if (ftruncate(fd, static_cast<off_t>(used)) == 0)
+                    capacity = used;
+            }
+        }
+
+        void Close()
+        {
+            if (data)
+                munmap(data, mapped);
+            if (fd >= 0)
+                ::close(fd);
+            data = nullptr;
+            mapped = 0;
+            fd = -1;
+        }
+
+        void Sync() const
+        {
+            if (data && msync(data, used, MS_SYNC) < 0)
+                throw std::system_error(errno, std::generic_category(), "msync " + path);
+        }
+
+        size_t GetCapacity() const
+        {
+            return capacity;
+        }
+
+        size_t Free() const
+        {
+            return capacity - used;
+        }
+
+        char *At(size_t position) const
+        {
+            return data + position;
+        }
+
+        // Length of the record at `position`, or -1 past the last record.
+        long long LengthAt(size_t position) const
+        {
+            if (position + HEADER_BYTES > capacity)
+                return -1;
+            Header header;
+            std::memcpy(&header, data + position, HEADER_BYTES);
+            if (header == 0 || position + HEADER_BYTES + header - 1 > capacity)
+                return -1;
+            return static_cast<long long>(header) - 1;
+        }
+
+        void Record(size_t length, size_t interval)
+        {
+            if (count == 0 || used - lastIndexed >= interval)
+            {
+                index.push_back({baseOffset + count, used});
+                lastIndexed = used;
+            }
+            used += HEADER_BYTES + length;
+            ++count;
+        }
+
+        // Byte position of `offset`, starting from the nearest index entry.
+        size_t Locate(long long offset) const
+        {
+            auto entry = std::upper_bound(index.begin(), index.end(), offset,
+                                          [](long long value, const IndexEntry &item)
+                                          { return value < item.offset; });
+            --entry;
+            size_t position = entry->position;
+            for (long long current = entry->offset; current < offset; ++current)
+            {
+                position += HEADER_BYTES + static_cast<size_t>(LengthAt(position));
+            }
+            return position;
+        }
+    };
+
+    Options options;
+    std::deque<std::unique_ptr<Segment>> segments;
+    long long firstOffset = 0;
+    long long nextOffset = 0;
+    size_t totalBytes = 0;
+
+    std::string PathFor(long long baseOffset) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%020lld.log", baseOffset);
+        return (std::filesystem::path(options.directory) / name).string();
+    }
+
+    // Maps every segment already in the directory and rebuilds its index.
+    void Recover()
+    {
+        std::vector<long long> bases;
+        for (const auto &file : std::filesystem::directory_iterator(options.directory))
+        {
+            std::string name = file.path().filename().string();
+            if (name.size() == 24 && name.compare(20, 4, ".log") == 0 &&
+                name.find_first_not_of("0123456789") == 20)
+                bases.push_back(std::stoll(name.substr(0, 20)));
+        }
+        std::sort(bases.begin(), bases.end());
+
+        for (long long base : bases)
+        {
+            auto segment = std::make_unique<Segment>(PathFor(base), base);
+            segment->Open();
+            long long length;
+            while ((length = segment->LengthAt(segment->used)) >= 0)
+            {
+                segment->Record(static_cast<size_t>(length), options.indexInterval);
+            }
+            // Segments that are empty or do not follow on from the previous
+            // one were never written to completely; drop them and everything
+            // after them.
+            if (segment->count == 0 || (!segments.empty() && base != nextOffset))
+            {
+                segment->Close();
+                std::filesystem::remove(segment->path);
+                continue;
+            }
+            segment->Seal();
+            if (segments.empty())
+                firstOffset = base;
+            nextOffset = base + segment->count;
+            totalBytes += segment->used;
+            segments.push_back(std::move(segment));
+        }
+    }
+
+    Segment &Roll(size_t needed)
+    {
+        if (!segments.empty())
+            segments.back()->Seal();
+        auto segment = std::make_unique<Segment>(PathFor(nextOffset), nextOffset);
+        segment->Create(std::max(options.segmentBytes, needed));
+        segments.push_back(std::move(segment));
+        if (options.maxSegments > 0)
+        {
+            while (static_cast<int>(segments.size()) > options.maxSegments)
+            {
+                DropOldest();
+            }
+        }
+        return *segments.back();
+    }
+
+    void DropOldest()
+    {
+        Segment &oldest = *segments.front();
+        totalBytes -= oldest.used;
+        firstOffset = oldest.baseOffset + oldest.count;
+        oldest.Close();
+        std::filesystem::remove(oldest.path);
+        segments.pop_front();
+    }
+
+    const Segment &SegmentFor(long long offset) const
+    {
+        if (offset < firstOffset)
+            throw std::out_of_range("Offset has been evicted");
+        if (offset >= nextOffset)
+            throw std::out_of_range("Offset has not been written yet");
+        auto found = std::upper_bound(segments.begin(), segments.end(), offset,
+                                      [](long long value, const std::unique_ptr<Segment> &segment)
+                                      { return value < segment->baseOffset; });
+        return **(found - 1);
+    }
+
+public:
+    // Opens the log in options.directory, creating the directory if needed
+    // and continuing after whatever complete records it already holds.
+    explicit SegmentLog(const Options &options) : options(options)
+    {
+        if (options.directory.empty())
+            throw std::invalid_argument("Segment log needs a directory");
+        if (options.segmentBytes < HEADER_BYTES || options.indexInterval == 0 || options.maxSegments < 0)
+            throw std::invalid_argument("Invalid segment log options");
+        std::filesystem::create_directories(options.directory);
+        Recover();
+        if (segments.empty())
+            firstOffset = nextOffset = 0;
+    }
+
+    SegmentLog(const SegmentLog &) = delete;
+    SegmentLog &operator=(const SegmentLog &) = delete;
+
+    ~SegmentLog()
+    {
+        if (!segments.empty())
+            segments.back()->Seal();
+    }
+
+    // Returns the offset the record was stored at.
+    long long Append(std::string_view record)
+    {
+        if (record.size() >= UINT32_MAX)
+            throw std::invalid_argument("Record is too large for a segment");
+        size_t needed = HEADER_BYTES + record.size();
+        // Recovered segments are sealed to their exact size, so the first
+        // append after reopening always starts a new one.
+        Segment *active = segments.empty() ? nullptr : segments.back().get();
+        if (!active || active->Free() < needed)
+            active = &Roll(needed);
+
+        char *target = active->At(active->used);
+        std::memcpy(target + HEADER_BYTES, record.data(), record.size());
+        Header header = static_cast<Header>(record.size() + 1);
+        std::memcpy(target, &header, HEADER_BYTES);
+        active->Record(record.size(), options.indexInterval);
+        totalBytes += needed;
+        return nextOffset++;
+    }
+
+    // The record at `offset` as a view into the mapped segment. The view
+    // stays valid until the segment holding it is deleted by maxSegments or
+    // DropBefore, or the log is destroyed.
+    std::string_view Read(long long offset) const
+    {
+        const Segment &segment = SegmentFor(offset);
+        size_t position = segment.Locate(offset);
+        return std::string_view(segment.At(position + HEADER_BYTES),
+                                static_cast<size_t>(segment.LengthAt(position)));
+    }
+
+    // Calls onRecord(offset, view) for every record in [from, to), walking
+    // each segment sequentially. Returns the offset after the last record
+    // visited.
+    template <typename OnRecord>
+    long long ForEach(long long from, long long to, OnRecord &&onRecord) const
+    {
+        from = std::max(from, firstOffset);
+        to = std::min(to, nextOffset);
+        if (from >= to)
+            return from;
+
+        auto found = std::upper_bound(segments.begin(), segments.end(), from,
+                                      [](long long value, const std::unique_ptr<Segment> &segment)
+                                      { return value < segment->baseOffset; });
+        long long offset = from;
+        for (auto it = found - 1; it != segments.end() && offset < to; ++it)
+        {
+            const Segment &segment = **it;
+            size_t position = segment.Locate(offset);
+            long long end = std::min(to, segment.baseOffset + segment.count);
+            for (; offset < end; ++offset)
+            {
+                size_t length = static_cast<size_t>(segment.LengthAt(position));
+                onRecord(offset, std::string_view(segment.At(position + HEADER_BYTES), length));
+                position += HEADER_BYTES + length;
+            }
+        }
+        return offset;
+    }
+
+    // Deletes every segment that holds only offsets below `offset`.
+    void DropBefore(long long offset)
+    {
+        while (segments.size() > 1 &&
+               segments.front()->baseOffset + segments.front()->count <= offset)
+        {
+            DropOldest();
+        }
+    }
+
+    // Blocks until everything appended so far is on disk.
+    void Sync() const
+    {
+        for (const auto &segment : segments)
+        {
+            segment->Sync();
+        }
+    }
+
+    long long GetFirstOffset() const
+    {
+        return firstOffset;
+    }
+
+    long long GetNextOffset() const
+    {
+        return nextOffset;
+    }
+
+    int GetSegmentCount() const
+    {
+        return static_cast<int>(segments.size());
+    }
+
+    // Bytes of records and headers held on disk.
+    size_t GetBytes() const
+    {
+        return totalBytes;
+    }
+
+    const Options &GetOptions() const
+    {
+        return options;
+    }
+};
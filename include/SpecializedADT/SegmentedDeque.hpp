@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 template <typename T>
 class SegmentedDeque : public MutableSequence<T>
@@ -25,6 +26,7 @@ private:
         {
             segments.insert(segments.begin(), std::make_unique<T[]>(SEGMENT_SIZE));
             headIndex = SEGMENT_SIZE;
+            tailIndex += SEGMENT_SIZE;
             bufferOffset++;
         }
     }
@@ -56,6 +58,7 @@ public:
         totalLength = other.totalLength;
         headIndex = other.headIndex;
         tailIndex = other.tailIndex;
+        bufferOffset = other.bufferOffset;
 
         segments.clear();
         for (const auto &seg : other.segments)
@@ -69,6 +72,30 @@ public:
         }
     }
 
+    // Leaves `other` empty with no segments; the first push at either end
+    // allocates one, so the move itself never allocates.
+    SegmentedDeque(SegmentedDeque &&other) noexcept
+        : segments(std::move(other.segments)), totalLength(other.totalLength),
+          headIndex(other.headIndex), tailIndex(other.tailIndex),
+          bufferOffset(other.bufferOffset)
+    {
+        other.segments.clear();
+        other.totalLength = 0;
+        other.headIndex = 0;
+        other.tailIndex = 0;
+        other.bufferOffset = 0;
+    }
+
+    SegmentedDeque &operator=(SegmentedDeque other) noexcept
+    {
+        segments.swap(other.segments);
+        std::swap(totalLength, other.totalLength);
+        std::swap(headIndex, other.headIndex);
+        std::swap(tailIndex, other.tailIndex);
+        std::swap(bufferOffset, other.bufferOffset);
+        return *this;
+    }
+
     T GetFirst() const override { return Get(0); }
 
     T GetLast() const override { return Get(totalLength - 1); }
@@ -125,7 +152,7 @@ public:
     {
         ensureSegmentBack();
         auto [seg, offset] = resolveIndex(totalLength);
-        segments[seg][offset] = item;
+        segments[seg][offset] = std::move(item);
         ++totalLength;
         ++tailIndex;
     }
@@ -135,7 +162,7 @@ public:
         ensureSegmentFront();
         --headIndex;
         auto [seg, offset] = resolveIndex(0);
-        segments[seg][offset] = item;
+        segments[seg][offset] = std::move(item);
         ++totalLength;
     }
 
@@ -162,12 +189,40 @@ public:
     {
         if (index < 0 || index >= totalLength)
             throw std::out_of_range("Index out of range");
+        if (index == 0)
+            return RemoveFirstInPlace();
         for (int i = index; i < totalLength - 1; ++i)
             (*this)[i] = Get(i + 1);
         --totalLength;
         --tailIndex;
     }
 
+    // O(1): only the head moves; a segment left empty behind it is freed.
+    void RemoveFirstInPlace()
+    {
+        if (totalLength == 0)
+            throw std::out_of_range("Index out of range");
+        (*this)[0] = T();
+        ++headIndex;
+        --totalLength;
+        if (headIndex >= SEGMENT_SIZE && segments.size() > 1)
+        {
+            segments.erase(segments.begin());
+            headIndex -= SEGMENT_SIZE;
+            tailIndex -= SEGMENT_SIZE;
+            bufferOffset--;
+        }
+    }
+
+    void RemoveLastInPlace()
+    {
+        if (totalLength == 0)
+            throw std::out_of_range("Index out of range");
+        (*this)[totalLength - 1] = T();
+        --totalLength;
+        --tailIndex;
+    }
+
     T &operator[](int index)
     {
         if (index < 0 || index >= totalLength)
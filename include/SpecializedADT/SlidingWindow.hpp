@@ -0,0 +1,128 @@
+#pragma once
+#include "include/core/RingBuffer.hpp"
+#include "include/SpecializedADT/MonotonicDeque.hpp"
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Aggregates over the last `size` pushed items: min and max through two
+// monotonic deques, and for arithmetic T a running sum and mean. All
+// queries are O(1) and Push is amortised O(1).
+template <typename T>
+class SlidingWindow
+{
+private:
+    using Sum = std::conditional_t<std::is_integral<T>::value, long long, double>;
+
+    int size;
+    RingBuffer<T> items;
+    MonotonicDeque<T, std::less<T>> minimum;
+    MonotonicDeque<T, std::greater<T>> maximum;
+    Sum sum = Sum();
+    long long pushed = 0;
+
+    // Floating-point subtraction drifts, so the sum is rebuilt exactly once
+    // per window length, which keeps Push amortised O(1).
+    void Resum()
+    {
+        sum = Sum();
+        for (int i = 0; i < items.GetLength(); ++i)
+        {
+            sum += items[i];
+        }
+    }
+
+public:
+    explicit SlidingWindow(int size) : size(size)
+    {
+        if (size <= 0)
+            throw std::invalid_argument("Window size must be positive");
+        items.Reserve(size);
+    }
+
+    void Push(const T &item)
+    {
+        if (items.GetLength() == size)
+        {
+            if constexpr (std::is_arithmetic<T>::value)
+                sum -= items.Front();
+            items.DropFront();
+        }
+        items.PushBack(item);
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            sum += item;
+            if (std::is_floating_point<T>::value && (pushed + 1) % size == 0)
+                Resum();
+        }
+
+        ++pushed;
+        minimum.Push(item);
+        maximum.Push(item);
+        minimum.ExpireBefore(pushed - size);
+        maximum.ExpireBefore(pushed - size);
+    }
+
+    const T &GetMin() const
+    {
+        if (items.IsEmpty())
+            throw std::out_of_range("SlidingWindow is empty");
+        return minimum.Front();
+    }
+
+    const T &GetMax() const
+    {
+        if (items.IsEmpty())
+            throw std::out_of_range("SlidingWindow is empty");
+        return maximum.Front();
+    }
+
+    Sum GetSum() const
+    {
+        static_assert(std::is_arithmetic<T>::value, "GetSum requires an arithmetic type");
+        return sum;
+    }
+
+    double GetMean() const
+    {
+        static_assert(std::is_arithmetic<T>::value, "GetMean requires an arithmetic type");
+        if (items.IsEmpty())
+            throw std::out_of_range("SlidingWindow is empty");
+        return static_cast<double>(sum) / items.GetLength();
+    }
+
+    const T &Get(int index) const
+    {
+        return items[index];
+    }
+
+    void Clear()
+    {
+        items.Clear();
+        minimum.Clear();
+        maximum.Clear();
+        sum = Sum();
+        pushed = 0;
+    }
+
+    int GetLength() const
+    {
+        return items.GetLength();
+    }
+
+    int GetSize() const
+    {
+        return size;
+    }
+
+    bool IsFull() const
+    {
+        return items.GetLength() == size;
+    }
+
+    bool IsEmpty() const
+    {
+        return items.IsEmpty();
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+// Publishes immutable versions of a value (typically an ImmutableSequence)
+// to reader threads, RCU style. Writers swap in a new version; readers keep
+// using the version they hold until they look again, and an old version is
+// freed when the last reader holding it lets go.
+//
+// Readers that poll at high rates should go through a Reader: its Get() is
+// a single acquire load of the version counter while nothing has changed,
+// and only after a publish does it take the cell's lock once to pick up the
+// new version. Writers never wait for readers to finish with old versions.
+template <typename S>
+class SnapshotCell
+{
+private:
+    std::shared_ptr<S> current;
+    mutable std::mutex currentMutex;
+    std::mutex updateMutex;
+    alignas(64) std::atomic<std::uint64_t> version{1};
+
+    void Swap(std::shared_ptr<S> &next)
+    {
+        if (!next)
+            throw std::invalid_argument("Snapshot cannot be null");
+        std::lock_guard<std::mutex> lock(currentMutex);
+        current.swap(next);
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+public:
+    class Reader
+    {
+    private:
+        const SnapshotCell *cell;
+        std::shared_ptr<S> cached;
+        std::uint64_t cachedVersion = 0;
+
+    public:
+        explicit Reader(const SnapshotCell &cell) : cell(&cell) {}
+
+        // The reference stays valid until the next Get() on this reader.
+        const S &Get()
+        {
+            if (cell->version.load(std::memory_order_acquire) != cachedVersion)
+            {
+                std::lock_guard<std::mutex> lock(cell->currentMutex);
+                cached = cell->current;
+                cachedVersion = cell->version.load(std::memory_order_relaxed);
+            }
+            return *cached;
+        }
+
+        std::uint64_t GetVersion() const
+        {
+            return cachedVersion;
+        }
+    };
+
+    explicit SnapshotCell(std::shared_ptr<S> initial) : current(std::move(initial))
+    {
+        if (!current)
+            throw std::invalid_argument("Snapshot cannot be null");
+    }
+
+    SnapshotCell(const SnapshotCell &) = delete;
+    SnapshotCell &operator=(const SnapshotCell &) = delete;
+
+    std::shared_ptr<const S> Load() const
+    {
+        std::lock_guard<std::mutex> lock(currentMutex);
+        return current;
+    }
+
+    // Waits for a running Update, so that one does not replace this version
+    // with a result built from the one before it.
+    void Publish(std::shared_ptr<S> next)
+    {
+        {
+            std::lock_guard<std::mutex> lock(updateMutex);
+            Swap(next);
+        }
+        // next now holds the previous version and is released here, outside
+        // the locks, in case this was the last reference to it.
+    }
+
+    // Builds the next version from the current one, e.g. with Append or
+    // Concat, which leave an immutable sequence untouched. Concurrent updates
+    // and publishes are serialised so none of them is lost; readers are not
+    // blocked.
+    template <typename Make>
+    void Update(Make make)
+    {
+        std::lock_guard<std::mutex> lock(updateMutex);
+        std::shared_ptr<S> base;
+        {
+            std::lock_guard<std::mutex> currentLock(currentMutex);
+            base = current;
+        }
+        std::shared_ptr<S> next(make(*base));
+        Swap(next);
+    }
+
+    std::uint64_t GetVersion() const
+    {
+        return version.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Wait-free bounded queue for exactly one producer thread and one consumer
+// thread. Each side owns one index and keeps a cached copy of the other
+// side's index, so the shared cache lines are only touched when the cached
+// view says the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscRingQueue
+{
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    struct alignas(T) Slot
+    {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    struct alignas(CACHE_LINE) ConsumerSide
+    {
+        std::atomic<std::size_t> head{0};
+        std::size_t cachedTail = 0;
+    };
+
+    struct alignas(CACHE_LINE) ProducerSide
+    {
+        std::atomic<std::size_t> tail{0};
+        std::size_t cachedHead = 0;
+    };
+
+    ConsumerSide consumer;
+    ProducerSide producer;
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    T *SlotAt(std::size_t index) const
+    {
+        return std::launder(reinterpret_cast<T *>(slots[index & mask].bytes));
+    }
+
+    void *RawSlotAt(std::size_t index) const
+    {
+        return slots[index & mask].bytes;
+    }
+
+    // Number of free slots as seen by the producer, refreshing the cached
+    // head only when the ring looks full.
+    std::size_t FreeSlots(std::size_t tail, std::size_t wanted)
+    {
+        std::size_t capacity = mask + 1;
+        std::size_t free = capacity - (tail - producer.cachedHead);
+        if (free < wanted)
+        {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            free = capacity - (tail - producer.cachedHead);
+        }
+        return free;
+    }
+
+    std::size_t ReadySlots(std::size_t head, std::size_t wanted)
+    {
+        std::size_t ready = consumer.cachedTail - head;
+        if (ready < wanted)
+        {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            ready = consumer.cachedTail - head;
+        }
+        return ready;
+    }
+
+public:
+    // Capacity is rounded up to a power of two.
+    explicit SpscRingQueue(int capacity)
+    {
+        if (capacity <= 0)
+            throw std::invalid_argument("Capacity must be positive");
+        std::size_t size = 1;
+        while (size < static_cast<std::size_t>(capacity))
+            size <<= 1;
+        mask = size - 1;
+        slots = std::make_unique<Slot[]>(size);
+    }
+
+    SpscRingQueue(const SpscRingQueue &) = delete;
+    SpscRingQueue &operator=(const SpscRingQueue &) = delete;
+
+    ~SpscRingQueue()
+    {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+        for (; head != tail; ++head)
+        {
+            SlotAt(head)->~T();
+        }
+    }
+
+    // Producer side.
+
+    template <typename... Args>
+    bool TryEmplace(Args &&...args)
+    {
+        std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+        if (FreeSlots(tail, 1) == 0)
+            return false;
+        new (RawSlotAt(tail)) T(std::forward<Args>(args)...);
+        producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T &item)
+    {
+        return TryEmplace(item);
+    }
+
+    bool TryPush(T &&item)
+    {
+        return TryEmplace(std::move(item));
+    }
+
+    // Pushes as many of the items as fit and publishes them with a single
+    // release store. Returns how many were pushed.
+    int TryPushN(const T *items, int count)
+    {
+        if (count < 0)
+            throw std::invalid_argument("Count cannot be negative");
+        std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+        std::size_t free = FreeSlots(tail, static_cast<std::size_t>(count));
+        int pushed = static_cast<int>(std::min(free, static_cast<std::size_t>(count)));
+        for (int i = 0; i < pushed; ++i)
+        {
+            new (RawSlotAt(tail + i)) T(items[i]);
+        }
+        if (pushed > 0)
+            producer.tail.store(tail + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    // Consumer side.
+
+    // Returns the oldest item in place, or nullptr when the queue is empty.
+    // The pointer stays valid until Pop is called.
+    T *TryFront()
+    {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        if (ReadySlots(head, 1) == 0)
+            return nullptr;
+        return SlotAt(head);
+    }
+
+    void Pop()
+    {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        if (ReadySlots(head, 1) == 0)
+            throw std::out_of_range("SpscRingQueue is empty");
+        SlotAt(head)->~T();
+        consumer.head.store(head + 1, std::memory_order_release);
+    }
+
+    bool TryPop(T &out)
+    {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        if (ReadySlots(head, 1) == 0)
+            return false;
+        T *item = SlotAt(head);
+        out = std::move(*item);
+        item->~T();
+        consumer.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    int TryPopN(T *out, int maxCount)
+    {
+        if (maxCount < 0)
+            throw std::invalid_argument("Count cannot be negative");
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        std::size_t ready = ReadySlots(head, static_cast<std::size_t>(maxCount));
+        int popped = static_cast<int>(std::min(ready, static_cast<std::size_t>(maxCount)));
+        for (int i = 0; i < popped; ++i)
+        {
+            T *item = SlotAt(head + i);
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        if (popped > 0)
+            consumer.head.store(head + popped, std::memory_order_release);
+        return popped;
+    }
+
+    // Either side; the value may be stale by the time it is used.
+
+    int GetLength() const
+    {
+        std::size_t head = consumer.head.load(std::memory_order_acquire);
+        std::size_t tail = producer.tail.load(std::memory_order_acquire);
+        return static_cast<int>(tail - head);
+    }
+
+    bool IsEmpty() const
+    {
+        return GetLength() == 0;
+    }
+
+    int GetCapacity() const
+    {
+        return static_cast<int>(mask + 1);
+    }
+};
@@ -0,0 +1,231 @@
+#pragma once
+#include "include/core/RingBuffer.hpp"
+#include "include/core/LinkedList.hpp"
+#include "include/SpecializedADT/SegmentedDeque.hpp"
+#include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Storage backends for the Queue and Deque adapters, chosen at compile time
+// so that the adapters' hot operations inline instead of going through a
+// virtual MutableSequence. Each policy offers PushBack, PushFront (both for
+// lvalues and rvalues), PopFront, PopBack, Front, Back and GetLength; the
+// adapters check for emptiness before popping or peeking. Front and Back
+// return a reference where the backend stores the item and a copy where it
+// can only hand one out.
+
+// Ring buffer: O(1) at both ends, one contiguous block.
+template <typename T>
+class RingStorage
+{
+private:
+    RingBuffer<T> items;
+
+public:
+    void PushBack(const T &item) { items.PushBack(item); }
+    void PushBack(T &&item) { items.PushBack(std::move(item)); }
+    void PushFront(const T &item) { items.PushFront(item); }
+    void PushFront(T &&item) { items.PushFront(std::move(item)); }
+    T PopFront() { return items.PopFront(); }
+    T PopBack() { return items.PopBack(); }
+    const T &Front() const { return items.Front(); }
+    const T &Back() const { return items.Back(); }
+    int GetLength() const { return items.GetLength(); }
+};
+
+// Contiguous array with a moving start: PopFront is O(1) and the consumed
+// prefix is compacted away once it makes up half the array. PushFront
+// reuses that prefix when there is one and shifts everything otherwise.
+template <typename T>
+class ArrayStorage
+{
+private:
+    std::vector<T> items;
+    int start = 0;
+
+    void Compact()
+    {
+        if (start > 32 && start * 2 >= static_cast<int>(items.size()))
+        {
+            items.erase(items.begin(), items.begin() + start);
+            start = 0;
+        }
+    }
+
+public:
+    void PushBack(const T &item) { items.push_back(item); }
+    void PushBack(T &&item) { items.push_back(std::move(item)); }
+
+    void PushFront(const T &item)
+    {
+        T copy(item);
+        PushFront(std::move(copy));
+    }
+
+    void PushFront(T &&item)
+    {
+        if (start > 0)
+            items[--start] = std::move(item);
+        else
+            items.insert(items.begin(), std::move(item));
+    }
+
+    T PopFront()
+    {
+        T item = std::move(items[start++]);
+        if (start == static_cast<int>(items.size()))
+        {
+            items.clear();
+            start = 0;
+        }
+        else
+        {
+            Compact();
+        }
+        return item;
+    }
+
+    T PopBack()
+    {
+        T item = std::move(items.back());
+        items.pop_back();
+        if (start == static_cast<int>(items.size()))
+        {
+            items.clear();
+            start = 0;
+        }
+        return item;
+    }
+
+    const T &Front() const { return items[start]; }
+    const T &Back() const { return items.back(); }
+    int GetLength() const { return static_cast<int>(items.size()) - start; }
+};
+
+// The library's SegmentedDeque: fixed 64-item segments, no reallocation of
+// stored items when growing at either end.
+template <typename T>
+class SegmentedStorage
+{
+private:
+    SegmentedDeque<T> items;
+
+public:
+    void PushBack(const T &item) { items.AppendInPlace(item); }
+    void PushBack(T &&item) { items.AppendInPlace(std::move(item)); }
+    void PushFront(const T &item) { items.PrependInPlace(item); }
+    void PushFront(T &&item) { items.PrependInPlace(std::move(item)); }
+
+    T PopFront()
+    {
+        T item = std::move(items[0]);
+        items.RemoveFirstInPlace();
+        return item;
+    }
+
+    T PopBack()
+    {
+        T item = std::move(items[items.GetLength() - 1]);
+        items.RemoveLastInPlace();
+        return item;
+    }
+
+    const T &Front() const { return items[0]; }
+    const T &Back() const { return items[items.GetLength() - 1]; }
+    int GetLength() const { return items.GetLength(); }
+};
+
+// The library's singly linked LinkedList: O(1) at the front and for
+// PushBack, O(n) for PopBack. Suits queues of large items that should
+// never be moved.
+template <typename T>
+class ListStorage
+{
+private:
+    LinkedList<T> items;
+
+public:
+    void PushBack(const T &item) { items.Append(item); }
+    void PushBack(T &&item) { items.Append(std::move(item)); }
+    void PushFront(const T &item) { items.Prepend(item); }
+    void PushFront(T &&item) { items.Prepend(std::move(item)); }
+
+    T PopFront()
+    {
+        T item = std::move(items.GetHead()->data);
+        items.RemoveAt(0);
+        return item;
+    }
+
+    T PopBack()
+    {
+        int last = items.GetLength() - 1;
+        T item = std::move(items[last]);
+        items.RemoveAt(last);
+        return item;
+    }
+
+    const T &Front() const { return items.GetHead()->data; }
+    const T &Back() const { return items[items.GetLength() - 1]; }
+    int GetLength() const { return items.GetLength(); }
+};
+
+// Runtime-polymorphic backend through a heap-allocated MutableSequence, the
+// way Queue and Deque used to store their items. Kept for comparison and
+// for callers that need to pick a sequence type at run time. The sequence
+// only hands out copies, so Front and Back return by value. A moved-from
+// storage holds no sequence and counts as empty until the next push.
+template <typename T, typename Sequence = ArrayMutableSequence<T>>
+class VirtualStorage
+{
+private:
+    std::unique_ptr<MutableSequence<T>> items = std::make_unique<Sequence>();
+
+    MutableSequence<T> &Items()
+    {
+        if (!items)
+            items = std::make_unique<Sequence>();
+        return *items;
+    }
+
+public:
+    VirtualStorage() = default;
+
+    VirtualStorage(const VirtualStorage &other)
+        : items(other.items ? std::make_unique<Sequence>(static_cast<const Sequence &>(*other.items))
+                            : std::make_unique<Sequence>())
+    {
+    }
+
+    VirtualStorage(VirtualStorage &&other) noexcept = default;
+
+    VirtualStorage &operator=(VirtualStorage other) noexcept
+    {
+        items.swap(other.items);
+        return *this;
+    }
+
+    void PushBack(const T &item) { Items().AppendInPlace(item); }
+    void PushBack(T &&item) { Items().AppendInPlace(std::move(item)); }
+    void PushFront(const T &item) { Items().PrependInPlace(item); }
+    void PushFront(T &&item) { Items().PrependInPlace(std::move(item)); }
+
+    T PopFront()
+    {
+        T item = items->GetFirst();
+        items->RemoveAtInPlace(0);
+        return item;
+    }
+
+    T PopBack()
+    {
+        T item = items->GetLast();
+        items->RemoveAtInPlace(items->GetLength() - 1);
+        return item;
+    }
+
+    T Front() const { return items->GetFirst(); }
+    T Back() const { return items->GetLast(); }
+    int GetLength() const { return items ? items->GetLength() : 0; }
+};
@@ -1,17 +1,430 @@
+#pragma once
 #include "include/Muttable/Array/ArrayMutableSequence.hpp"
+#include "include/SpecializedADT/SegmentLog.hpp"
+#include "include/core/RingBuffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
+// Bytes an item counts for against RetentionPolicy::maxBytes.
+template <typename T>
+struct StreamItemSize
+{
+    static size_t Of(const T &) { return sizeof(T); }
+};
+
+template <>
+struct StreamItemSize<std::string>
+{
+    static size_t Of(const std::string &item) { return item.size(); }
+};
+
+// How an item is stored as a SegmentLog record. Strings are stored as their
+// bytes; other types must be trivially copyable and are stored verbatim.
+template <typename T>
+struct StreamItemCodec
+{
+    static std::string_view Encode(const T &item)
+    {
+        return std::string_view(reinterpret_cast<const char *>(&item), sizeof(T));
+    }
+
+    static T Decode(std::string_view bytes)
+    {
+        if (bytes.size() != sizeof(T))
+            throw std::invalid_argument("Record does not hold an item of this type");
+        T item;
+        std::memcpy(&item, bytes.data(), sizeof(T));
+        return item;
+    }
+};
+
+template <>
+struct StreamItemCodec<std::string>
+{
+    static std::string_view Encode(const std::string &item) { return item; }
+    static std::string Decode(std::string_view bytes) { return std::string(bytes); }
+};
+
+// Limits on what a BufferedStream keeps; zero disables a limit. The byte
+// limit never evicts the newest entry, so one oversized item is still kept.
+struct RetentionPolicy
+{
+    int maxCount = 0;
+    size_t maxBytes = 0;
+    std::chrono::steady_clock::duration maxAge = std::chrono::steady_clock::duration::zero();
+};
+
+// Append-only message log. Every committed item gets an offset one higher
+// than the previous one; offsets survive eviction, so a consumer holding an
+// offset below GetFirstOffset() knows it has fallen behind. Entries live in
+// a RingBuffer and retention drops them from the front in O(1). As a
+// MutableSequence, index 0 is the oldest retained entry; positional edits
+// other than appending renumber the entries after them.
+//
+// A stream built over a SegmentLog also writes every commit to the log. The
+// retention policy then only bounds the hot tail kept in memory: evicted
+// offsets, down to GetOldestOffset(), are replayed to consumers straight
+// from the mapped segments and can be read on the writer's thread with
+// ReadAtOffset. Such a stream is append-only.
+//
+// Consumers read the stream through named cursors from Subscribe. Poll hands
+// out the next entries by reference, and any number of consumers may poll
+// from their own threads while one writer commits: a Batch holds a shared
+// lock that keeps its entries in place, and commits and evictions wait for
+// it, so batches should be released promptly and never held by the writer's
+// own thread across a commit. Every other member is for the writer's thread.
 template <typename T>
 class BufferedStream : public MutableSequence<T>
 {
 private:
-    std::unique_ptr<MutableSequence<T>> buffer;
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        T item;
+        Clock::time_point committed;
+
+        template <typename... Args>
+        explicit Entry(Clock::time_point committed, Args &&...args)
+            : item(std::forward<Args>(args)...), committed(committed) {}
+    };
+
+    struct Cursor
+    {
+        std::atomic<long long> committed{-1};
+    };
+
+    RingBuffer<Entry> entries;
+    RetentionPolicy retention;
+    long long firstOffset = 0;
+    size_t retainedBytes = 0;
     std::optional<T> current;
+    std::unique_ptr<SegmentLog> log;
+    mutable std::shared_mutex access;
+    std::map<std::string, Cursor> cursors;
+    std::atomic<int> writersWaiting{0};
+    std::vector<T> staged;
+    int groupSize = 1;
+
+    static constexpr bool SPILLABLE = std::is_trivially_copyable<T>::value || std::is_same<T, std::string>::value;
+
+    // Pollers back off while a writer waits: the shared_mutex may favour
+    // readers, and a steady stream of polls would otherwise starve commits.
+    std::unique_lock<std::shared_mutex> LockForWrite()
+    {
+        writersWaiting.fetch_add(1);
+        std::unique_lock<std::shared_mutex> lock(access);
+        writersWaiting.fetch_sub(1);
+        return lock;
+    }
+
+    // Appends one entry; the caller holds the write lock and runs Enforce
+    // once it has appended everything.
+    template <typename... Args>
+    void AppendLocked(Clock::time_point now, Args &&...args)
+    {
+        const T &item = entries.EmplaceBack(now, std::forward<Args>(args)...).item;
+        retainedBytes += StreamItemSize<T>::Of(item);
+        if (log)
+            log->Append(StreamItemCodec<T>::Encode(item));
+    }
+
+    void FlushLocked(Clock::time_point now)
+    {
+        for (T &item : staged)
+        {
+            AppendLocked(now, std::move(item));
+        }
+        staged.clear();
+    }
+
+    long long Push(T &&item)
+    {
+        return Emplace(std::move(item));
+    }
+
+    void EvictFront()
+    {
+        retainedBytes -= StreamItemSize<T>::Of(entries.Front().item);
+        entries.DropFront();
+        ++firstOffset;
+    }
+
+    void Enforce(Clock::time_point now)
+    {
+        while (retention.maxCount > 0 && entries.GetLength() > retention.maxCount)
+        {
+            EvictFront();
+        }
+        while (retention.maxBytes > 0 && retainedBytes > retention.maxBytes && entries.GetLength() > 1)
+        {
+            EvictFront();
+        }
+        if (retention.maxAge > Clock::duration::zero())
+        {
+            while (!entries.IsEmpty() && now - entries.Front().committed > retention.maxAge)
+            {
+                EvictFront();
+            }
+        }
+    }
+
+    std::unique_ptr<ArrayMutableSequence<T>> CopyItems() const
+    {
+        auto copy = std::make_unique<ArrayMutableSequence<T>>();
+        for (int i = 0; i < entries.GetLength(); ++i)
+        {
+            copy->AppendInPlace(entries[i].item);
+        }
+        return copy;
+    }
 
 public:
-    BufferedStream(){
-        buffer = std::make_unique<ArrayMutableSequence<T>>();
+    // Contiguous entries handed out by Consumer::Poll, either from memory
+    // or, for offsets that have been evicted, from the segment log. The
+    // references and views stay valid for the life of the batch.
+    class Batch
+    {
+    private:
+        std::shared_lock<std::shared_mutex> lock;
+        const RingBuffer<Entry> *entries = nullptr;
+        // Views into the mapped segments when the batch comes from the log.
+        std::vector<std::string_view> records;
+        mutable std::vector<T> decoded;
+        int start = 0;
+        int count = 0;
+        long long firstOffset = 0;
+
+        friend class BufferedStream;
+
+        void CheckIndex(int index) const
+        {
+            if (index < 0 || index >= count)
+                throw std::out_of_range("Index out of range");
+        }
+
+    public:
+        Batch() = default;
+
+        // Entries replayed from the log are decoded into copies held by the
+        // batch the first time one is asked for; View avoids that.
+        const T &operator[](int index) const
+        {
+            CheckIndex(index);
+            if (entries)
+                return (*entries)[start + index].item;
+            if constexpr (SPILLABLE)
+            {
+                if (decoded.empty())
+                {
+                    decoded.reserve(records.size());
+                    for (std::string_view record : records)
+                    {
+                        decoded.push_back(StreamItemCodec<T>::Decode(record));
+                    }
+                }
+            }
+            return decoded[index];
+        }
+
+        // The entry's bytes as the segment log stores them, without a copy
+        // whether it is in memory or in a mapped segment.
+        std::string_view View(int index) const
+        {
+            CheckIndex(index);
+            if (entries)
+                return StreamItemCodec<T>::Encode((*entries)[start + index].item);
+            return records[index];
+        }
+
+        // True when the entries were replayed from the segment log.
+        bool IsSpilled() const
+        {
+            return entries == nullptr && count > 0;
+        }
+
+        int GetLength() const
+        {
+            return count;
+        }
+
+        bool IsEmpty() const
+        {
+            return count == 0;
+        }
+
+        // Offset of the first entry; higher than the consumer's position
+        // when retention evicted entries before it could read them.
+        long long GetFirstOffset() const
+        {
+            return firstOffset;
+        }
+
+        long long GetNextOffset() const
+        {
+            return firstOffset + count;
+        }
+    };
+
+    // A named read position. Polling advances the position; Commit records
+    // how far the consumer has processed, and a later Subscribe under the
+    // same name resumes from there. One consumer is used by one thread.
+    class Consumer
+    {
+    private:
+        BufferedStream *stream;
+        Cursor *cursor;
+        std::string name;
+        long long position;
+
+        friend class BufferedStream;
+
+        Consumer(BufferedStream &stream, Cursor &cursor, std::string name, long long position)
+            : stream(&stream), cursor(&cursor), name(std::move(name)), position(position) {}
+
+    public:
+        // Up to maxN entries from the current position, which moves past
+        // them. The batch is empty once the consumer has caught up.
+        Batch Poll(int maxN)
+        {
+            if (maxN <= 0)
+                throw std::invalid_argument("Batch size must be positive");
+            while (stream->writersWaiting.load() > 0)
+            {
+                std::this_thread::yield();
+            }
+            Batch batch;
+            batch.lock = std::shared_lock<std::shared_mutex>(stream->access);
+            // Appends wait for the shared lock, so no segment is rolled or
+            // deleted while the batch holds views into the log.
+            if (stream->log && position < stream->firstOffset)
+            {
+                position = std::max(position, stream->log->GetFirstOffset());
+                if (position < stream->firstOffset)
+                {
+                    long long end = std::min(stream->firstOffset, position + maxN);
+                    batch.records.reserve(static_cast<size_t>(end - position));
+                    stream->log->ForEach(position, end, [&](long long, std::string_view record)
+                                         { batch.records.push_back(record); });
+                    batch.count = static_cast<int>(batch.records.size());
+                    batch.firstOffset = position;
+                    position += batch.count;
+                    return batch;
+                }
+            }
+            position = std::max(position, stream->firstOffset);
+            long long available = std::max(0LL, stream->firstOffset + stream->entries.GetLength() - position);
+            batch.entries = &stream->entries;
+            batch.start = static_cast<int>(position - stream->firstOffset);
+            batch.count = static_cast<int>(std::min<long long>(available, maxN));
+            batch.firstOffset = position;
+            position += batch.count;
+            return batch;
+        }
+
+        // Moves the read position; the next Poll starts at `offset`, or at
+        // the oldest entry still in memory or in the segment log if that has
+        // been evicted.
+        void Seek(long long offset)
+        {
+            if (offset < 0)
+                throw std::out_of_range("Offset cannot be negative");
+            position = offset;
+        }
+
+        // Acknowledges everything before the current position.
+        void Commit()
+        {
+            Commit(position);
+        }
+
+        // Acknowledges everything before `offset`. Commits never move back.
+        void Commit(long long offset)
+        {
+            long long previous = cursor->committed.load();
+            while (offset > previous && !cursor->committed.compare_exchange_weak(previous, offset))
+            {
+            }
+        }
+
+        long long GetPosition() const
+        {
+            return position;
+        }
+
+        // Offset the consumer resumes from after a restart, or -1 before
+        // its first commit.
+        long long GetCommittedOffset() const
+        {
+            return cursor->committed.load();
+        }
+
+        const std::string &GetName() const
+        {
+            return name;
+        }
+    };
+
+    BufferedStream() = default;
+
+    explicit BufferedStream(const RetentionPolicy &retention) : retention(retention)
+    {
+        if (retention.maxCount < 0)
+            throw std::invalid_argument("Retention count cannot be negative");
+    }
+
+    // Continues the offsets of `log`, which may already hold records from
+    // an earlier run; consumers that seek back replay them from the log.
+    BufferedStream(const RetentionPolicy &retention, std::unique_ptr<SegmentLog> log)
+        : BufferedStream(retention)
+    {
+        static_assert(SPILLABLE, "Spilled stream items must be strings or trivially copyable");
+        if (!log)
+            throw std::invalid_argument("Segment log is null");
+        this->log = std::move(log);
+        firstOffset = this->log->GetNextOffset();
+    }
+
+    BufferedStream(const BufferedStream &) = delete;
+    BufferedStream &operator=(const BufferedStream &) = delete;
+
+    // Staged items are published rather than dropped.
+    ~BufferedStream() override
+    {
+        Flush();
+    }
+
+    void SetRetention(const RetentionPolicy &policy)
+    {
+        if (policy.maxCount < 0)
+            throw std::invalid_argument("Retention count cannot be negative");
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        retention = policy;
+        Enforce(Clock::now());
+    }
+
+    const RetentionPolicy &GetRetention() const
+    {
+        return retention;
+    }
+
+    // Applies the age limit without waiting for the next commit.
+    void EvictExpired()
+    {
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Enforce(Clock::now());
     }
 
     void SetCurrent(const T &item)
@@ -19,6 +432,11 @@ public:
         current = item;
     }
 
+    void SetCurrent(T &&item)
+    {
+        current = std::move(item);
+    }
+
     const std::optional<T> &GetCurrent() const
     {
         return current;
@@ -28,68 +446,266 @@ public:
     {
         if (current.has_value())
         {
-            buffer->AppendInPlace(current.value());
+            Emplace(std::move(*current));
             current.reset();
         }
     }
 
-    void Add(const T& item)
+    // Returns the offset the item was stored at.
+    long long Add(const T &item)
+    {
+        return Emplace(item);
+    }
+
+    long long Add(T &&item)
     {
-        buffer->AppendInPlace(item);
+        return Emplace(std::move(item));
     }
 
-    T GetFirst() const override { return buffer->GetFirst(); }
-    T GetLast() const override { return buffer->GetLast(); }
-    T Get(int index) const override { return buffer->Get(index); }
-    int GetLength() const override { return buffer->GetLength(); }
+    // Constructs the item in place from `args` and returns its offset. In
+    // group-commit mode the item is staged and published with its group.
+    template <typename... Args>
+    long long Emplace(Args &&...args)
+    {
+        if (groupSize > 1)
+        {
+            staged.emplace_back(std::forward<Args>(args)...);
+            long long offset = GetNextOffset() + static_cast<long long>(staged.size()) - 1;
+            if (static_cast<int>(staged.size()) >= groupSize)
+                Flush();
+            return offset;
+        }
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Clock::time_point now = Clock::now();
+        AppendLocked(now, std::forward<Args>(args)...);
+        long long offset = GetNextOffset() - 1;
+        Enforce(now);
+        return offset;
+    }
+
+    // Commits [first, last) under one lock with one timestamp, after any
+    // staged items; pass move iterators to move the items in. Returns the
+    // offset of the first item.
+    template <typename Iterator>
+    long long CommitBatch(Iterator first, Iterator last)
+    {
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Clock::time_point now = Clock::now();
+        FlushLocked(now);
+        long long offset = GetNextOffset();
+        for (; first != last; ++first)
+        {
+            AppendLocked(now, *first);
+        }
+        Enforce(now);
+        return offset;
+    }
+
+    // With a size above one, commits are staged without locking and
+    // published `size` at a time, so consumers see them only after the
+    // group fills or Flush is called. A size of one commits immediately.
+    void SetGroupCommit(int size)
+    {
+        if (size <= 0)
+            throw std::invalid_argument("Group size must be positive");
+        groupSize = size;
+        if (static_cast<int>(staged.size()) >= groupSize)
+            Flush();
+        staged.reserve(groupSize);
+    }
+
+    int GetGroupCommit() const
+    {
+        return groupSize;
+    }
+
+    // Publishes every staged item.
+    void Flush()
+    {
+        if (staged.empty())
+            return;
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Clock::time_point now = Clock::now();
+        FlushLocked(now);
+        Enforce(now);
+    }
+
+    int GetStagedCount() const
+    {
+        return static_cast<int>(staged.size());
+    }
+
+    long long GetFirstOffset() const
+    {
+        return firstOffset;
+    }
+
+    long long GetNextOffset() const
+    {
+        return firstOffset + entries.GetLength();
+    }
+
+    const T &GetAtOffset(long long offset) const
+    {
+        if (offset < firstOffset)
+            throw std::out_of_range("Offset has been evicted");
+        if (offset >= GetNextOffset())
+            throw std::out_of_range("Offset has not been written yet");
+        return entries[static_cast<int>(offset - firstOffset)].item;
+    }
+
+    // Cursor named `name`, starting at its committed offset or, for a new
+    // name, at the oldest retained entry.
+    Consumer Subscribe(const std::string &name)
+    {
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Cursor &cursor = cursors[name];
+        long long committed = cursor.committed.load();
+        return Consumer(*this, cursor, name, committed >= 0 ? committed : firstOffset);
+    }
+
+    // Committed offset of the consumer named `name`, or -1.
+    long long GetCommittedOffset(const std::string &name) const
+    {
+        std::shared_lock<std::shared_mutex> lock(access);
+        auto found = cursors.find(name);
+        return found == cursors.end() ? -1 : found->second.committed.load();
+    }
+
+    // Like GetAtOffset, but falls back to the segment log for offsets that
+    // have left memory.
+    T ReadAtOffset(long long offset) const
+    {
+        if (log && offset < firstOffset)
+            return StreamItemCodec<T>::Decode(log->Read(offset));
+        return GetAtOffset(offset);
+    }
+
+    // Lowest offset ReadAtOffset can still return.
+    long long GetOldestOffset() const
+    {
+        return log ? log->GetFirstOffset() : firstOffset;
+    }
+
+    const SegmentLog *GetLog() const
+    {
+        return log.get();
+    }
+
+    size_t GetRetainedBytes() const
+    {
+        return retainedBytes;
+    }
+
+    T GetFirst() const override
+    {
+        if (entries.IsEmpty())
+            throw std::out_of_range("Sequence is empty");
+        return entries.Front().item;
+    }
+
+    T GetLast() const override
+    {
+        if (entries.IsEmpty())
+            throw std::out_of_range("Sequence is empty");
+        return entries.Back().item;
+    }
+
+    T Get(int index) const override { return entries[index].item; }
+    int GetLength() const override { return entries.GetLength(); }
 
     std::unique_ptr<ISequence<T>> GetSubsequence(int startIndex, int endIndex) const override
     {
-        return buffer->GetSubsequence(startIndex, endIndex);
+        return CopyItems()->GetSubsequence(startIndex, endIndex);
     }
 
     std::unique_ptr<ISequence<T>> Append(T item) override
     {
-        return buffer->Append(item);
+        return CopyItems()->Append(item);
     }
 
     std::unique_ptr<ISequence<T>> Prepend(T item) override
     {
-        return buffer->Prepend(item);
+        return CopyItems()->Prepend(item);
     }
 
     std::unique_ptr<ISequence<T>> InsertAt(T item, int index) override
     {
-        return buffer->InsertAt(item, index);
+        return CopyItems()->InsertAt(item, index);
     }
 
     std::unique_ptr<ISequence<T>> Concat(const ISequence<T> *list) override
     {
-        return buffer->Concat(list);
+        return CopyItems()->Concat(list);
     }
 
     void AppendInPlace(T item) override
     {
-        buffer->AppendInPlace(item);
+        Push(std::move(item));
     }
 
     void PrependInPlace(T item) override
     {
-        buffer->PrependInPlace(item);
+        InsertAtInPlace(item, 0);
     }
 
     void InsertAtInPlace(T item, int index) override
     {
-        buffer->InsertAtInPlace(item, index);
+        Flush();
+        if (index < 0 || index > entries.GetLength())
+            throw std::out_of_range("Invalid index");
+        if (index == entries.GetLength())
+        {
+            Push(std::move(item));
+            return;
+        }
+        if (log)
+            throw std::logic_error("A stream with a segment log is append-only");
+
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        Clock::time_point now = Clock::now();
+        RingBuffer<Entry> rebuilt(entries.GetLength() + 1);
+        for (int i = 0; i < entries.GetLength(); ++i)
+        {
+            if (i == index)
+                rebuilt.EmplaceBack(now, std::move(item));
+            rebuilt.EmplaceBack(std::move(entries[i]));
+        }
+        retainedBytes += StreamItemSize<T>::Of(rebuilt[index].item);
+        entries = std::move(rebuilt);
+        Enforce(now);
     }
 
     void RemoveAtInPlace(int index) override
     {
-        buffer->RemoveAtInPlace(index);
+        Flush();
+        if (index < 0 || index >= entries.GetLength())
+            throw std::out_of_range("Invalid index");
+        std::unique_lock<std::shared_mutex> lock = LockForWrite();
+        if (index == 0)
+        {
+            EvictFront();
+            return;
+        }
+        if (log)
+            throw std::logic_error("A stream with a segment log is append-only");
+
+        RingBuffer<Entry> rebuilt(entries.GetLength());
+        retainedBytes -= StreamItemSize<T>::Of(entries[index].item);
+        for (int i = 0; i < entries.GetLength(); ++i)
+        {
+            if (i != index)
+                rebuilt.EmplaceBack(std::move(entries[i]));
+        }
+        entries = std::move(rebuilt);
     }
 
     void ConcatInPlace(const ISequence<T> *list) override
     {
-        buffer->ConcatInPlace(list);
+        int listSize = list->GetLength();
+        for (int i = 0; i < listSize; ++i)
+        {
+            Push(list->Get(i));
+        }
     }
-};
\ No newline at end of file
+};
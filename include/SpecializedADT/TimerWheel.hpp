@@ -0,0 +1,323 @@
+#pragma once
+#include "include/core/NodePool.hpp"
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Hierarchical timing wheel (Varghese & Lauck): eight levels of 256 slots
+// cover the whole 64-bit tick range. A timer sits in the level of the
+// highest bit in which its expiry differs from the current tick and moves
+// down a level each time that level's slot comes round, so Schedule,
+// Cancel and Reschedule are O(1) and each tick fires its slot as a batch.
+// Nodes come from a NodePool; handles go through a slot table with
+// generations, like IndexedPriorityQueue, so stale handles are rejected.
+template <typename T>
+class TimerWheel
+{
+public:
+    struct Handle
+    {
+        int slot = -1;
+        unsigned generation = 0;
+    };
+
+private:
+    static constexpr int LEVELS = 8;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+    struct Node
+    {
+        T item;
+        int slot;
+        int level = 0;
+        Node *prev = nullptr;
+        Node *next = nullptr;
+        Node **bucket = nullptr;
+
+        Node(T &&item, int slot) : item(std::move(item)), slot(slot) {}
+    };
+
+    // The expiry lives here rather than in the node so that pushing a
+    // deadline back touches one cache line fewer.
+    struct Slot
+    {
+        Node *node;
+        unsigned generation;
+        unsigned long long expiry;
+    };
+
+    NodePool<Node> pool;
+    Node *wheel[LEVELS][SLOTS] = {};
+    int levelCounts[LEVELS] = {};
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    unsigned long long currentTick = 0;
+    int count = 0;
+
+    static int LevelOf(unsigned long long expiry, unsigned long long now)
+    {
+        unsigned long long diff = expiry ^ now;
+        if (diff < SLOTS)
+            return 0;
+        int highBit = 63 - __builtin_clzll(diff);
+        return highBit / SLOT_BITS;
+    }
+
+    void Link(Node *node)
+    {
+        unsigned long long expiry = slots[node->slot].expiry;
+        int level = LevelOf(expiry, currentTick);
+        Node **bucket = &wheel[level][(expiry >> (level * SLOT_BITS)) & (SLOTS - 1)];
+        node->bucket = bucket;
+        node->level = level;
+        ++levelCounts[level];
+        node->prev = nullptr;
+        node->next = *bucket;
+        if (*bucket)
+            (*bucket)->prev = node;
+        *bucket = node;
+    }
+
+    void Unlink(Node *node)
+    {
+        --levelCounts[node->level];
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            *node->bucket = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+    }
+
+    int AcquireSlot(unsigned long long expiry)
+    {
+        if (!freeSlots.empty())
+        {
+            int slot = freeSlots.back();
+            freeSlots.pop_back();
+            slots[slot].expiry = expiry;
+            return slot;
+        }
+        slots.push_back({nullptr, 0, expiry});
+        return static_cast<int>(slots.size()) - 1;
+    }
+
+    void ReleaseNode(Node *node)
+    {
+        Slot &slot = slots[node->slot];
+        slot.node = nullptr;
+        ++slot.generation;
+        freeSlots.push_back(node->slot);
+        pool.Release(node);
+        --count;
+    }
+
+    Node *NodeOf(Handle handle) const
+    {
+        if (!Contains(handle))
+            throw std::out_of_range("Handle is not in the wheel");
+        return slots[handle.slot].node;
+    }
+
+    unsigned long long ExpiryAfter(unsigned long long delay) const
+    {
+        if (delay == 0)
+            delay = 1;
+        if (delay > ~0ULL - currentTick)
+            throw std::invalid_argument("Delay overflows the tick counter");
+        return currentTick + delay;
+    }
+
+    // Called when the tick crosses a multiple of 256: re-files the slot the
+    // new tick has reached on every upper level that wrapped, highest first,
+    // so its timers drop into finer levels.
+    void Cascade()
+    {
+        int top = 1;
+        while (top + 1 < LEVELS && (currentTick & ((1ULL << ((top + 1) * SLOT_BITS)) - 1)) == 0)
+        {
+            ++top;
+        }
+        for (int level = top; level >= 1; --level)
+        {
+            Node **bucket = &wheel[level][(currentTick >> (level * SLOT_BITS)) & (SLOTS - 1)];
+            Node *node = *bucket;
+            *bucket = nullptr;
+            while (node)
+            {
+                Node *next = node->next;
+                --levelCounts[level];
+                Link(node);
+                node = next;
+            }
+        }
+    }
+
+public:
+    TimerWheel() = default;
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    ~TimerWheel()
+    {
+        Clear();
+    }
+
+    // Fires `delay` ticks from now; a zero delay fires on the next tick.
+    Handle Schedule(unsigned long long delay, const T &item)
+    {
+        T copy(item);
+        return Schedule(delay, std::move(copy));
+    }
+
+    Handle Schedule(unsigned long long delay, T &&item)
+    {
+        int slot = AcquireSlot(ExpiryAfter(delay));
+        Node *node = pool.Allocate(std::move(item), slot);
+        slots[slot].node = node;
+        Link(node);
+        ++count;
+        return {slot, slots[slot].generation};
+    }
+
+    bool Contains(Handle handle) const
+    {
+        return handle.slot >= 0 && handle.slot < static_cast<int>(slots.size()) &&
+               slots[handle.slot].generation == handle.generation &&
+               slots[handle.slot].node != nullptr;
+    }
+
+    bool Cancel(Handle handle)
+    {
+        if (!Contains(handle))
+            return false;
+        Node *node = slots[handle.slot].node;
+        Unlink(node);
+        ReleaseNode(node);
+        return true;
+    }
+
+    // Pushing a deadline back, the common case for idle timeouts, only
+    // records the new expiry: the node's current slot comes round no later
+    // than its old expiry and re-files it then. Pulling a deadline forward
+    // moves the node straight away.
+    void Reschedule(Handle handle, unsigned long long delay)
+    {
+        if (!Contains(handle))
+            throw std::out_of_range("Handle is not in the wheel");
+        Slot &slot = slots[handle.slot];
+        unsigned long long expiry = ExpiryAfter(delay);
+        bool later = expiry >= slot.expiry;
+        slot.expiry = expiry;
+        if (!later)
+        {
+            Unlink(slot.node);
+            Link(slot.node);
+        }
+    }
+
+    const T &Get(Handle handle) const
+    {
+        return NodeOf(handle)->item;
+    }
+
+    unsigned long long GetExpiry(Handle handle) const
+    {
+        if (!Contains(handle))
+            throw std::out_of_range("Handle is not in the wheel");
+        return slots[handle.slot].expiry;
+    }
+
+    // Moves time forward by `ticks`, calling onExpire(T &&) for every timer
+    // that comes due, in tick order. Callbacks may schedule or cancel
+    // timers. Returns the number of timers fired.
+    template <typename OnExpire>
+    int Advance(unsigned long long ticks, OnExpire &&onExpire)
+    {
+        if (ticks > ~0ULL - currentTick)
+            throw std::invalid_argument("Advance overflows the tick counter");
+        unsigned long long target = currentTick + ticks;
+        int fired = 0;
+        while (currentTick < target)
+        {
+            if (count == 0)
+            {
+                currentTick = target;
+                break;
+            }
+
+            // With the finer levels empty nothing can fire before the next
+            // boundary of the first occupied level, so jump straight to it.
+            int occupied = 0;
+            while (levelCounts[occupied] == 0)
+                ++occupied;
+            if (occupied > 0)
+            {
+                unsigned long long span = (1ULL << (occupied * SLOT_BITS)) - 1;
+                unsigned long long boundary = currentTick | span;
+                if (boundary >= target)
+                {
+                    currentTick = target;
+                    break;
+                }
+                currentTick = boundary;
+            }
+
+            ++currentTick;
+            if ((currentTick & (SLOTS - 1)) == 0)
+                Cascade();
+
+            Node **bucket = &wheel[0][currentTick & (SLOTS - 1)];
+            while (Node *node = *bucket)
+            {
+                Unlink(node);
+                if (slots[node->slot].expiry != currentTick)
+                {
+                    Link(node);
+                    continue;
+                }
+                T item = std::move(node->item);
+                ReleaseNode(node);
+                ++fired;
+                onExpire(std::move(item));
+            }
+        }
+        return fired;
+    }
+
+    void Clear()
+    {
+        for (auto &level : wheel)
+        {
+            for (Node *&bucket : level)
+            {
+                while (Node *node = bucket)
+                {
+                    bucket = node->next;
+                    ReleaseNode(node);
+                }
+            }
+        }
+        for (int &levelCount : levelCounts)
+        {
+            levelCount = 0;
+        }
+    }
+
+    unsigned long long GetCurrentTick() const
+    {
+        return currentTick;
+    }
+
+    int GetLength() const
+    {
+        return count;
+    }
+
+    bool IsEmpty() const
+    {
+        return count == 0;
+    }
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque, with the memory orderings from Le et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP'13).
+// Only the owning thread may call PushBottom/PopBottom; any thread may call
+// Steal. Items are stored in atomics, so T has to be trivially copyable
+// (typically a task pointer or index). Outgrown arrays are kept alive until
+// the deque is destroyed because a thief may still be reading from one.
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque items must be trivially copyable");
+
+private:
+    struct Array
+    {
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(std::int64_t capacity)
+            : capacity(capacity), mask(capacity - 1), items(new std::atomic<T>[capacity])
+        {
+        }
+
+        T Get(std::int64_t index) const
+        {
+            return items[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void Put(std::int64_t index, T item)
+        {
+            items[index & mask].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+    alignas(64) std::atomic<Array *> array;
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    Array *Grow(Array *old, std::int64_t from, std::int64_t to)
+    {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (std::int64_t i = from; i < to; ++i)
+        {
+            bigger->Put(i, old->Get(i));
+        }
+        Array *result = bigger.get();
+        arrays.push_back(std::move(bigger));
+        return result;
+    }
+
+public:
+    // Capacity is rounded up to a power of two; the deque grows as needed.
+    explicit WorkStealingDeque(int capacity = 64)
+    {
+        if (capacity <= 0)
+            throw std::invalid_argument("Capacity must be positive");
+        std::int64_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        arrays.push_back(std::make_unique<Array>(size));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only.
+    void PushBottom(T item)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1)
+        {
+            a = Grow(a, t, b);
+            array.store(a, std::memory_order_release);
+        }
+        a->Put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only. Takes the most recently pushed item (LIFO).
+    bool PopBottom(T &out)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T item = a->Get(b);
+        if (t == b)
+        {
+            // Last item: race any thief for it through top, and leave `out`
+            // alone if the thief wins.
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won)
+                return false;
+        }
+        out = std::move(item);
+        return true;
+    }
+
+    // Any thread. Takes the oldest item (FIFO). Returns false when the deque
+    // is empty or another thread won the race for the same item.
+    bool Steal(T &out)
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+
+        Array *a = array.load(std::memory_order_acquire);
+        T item = a->Get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+            return false;
+        out = item;
+        return true;
+    }
+
+    // Approximate when other threads are stealing.
+    int GetLength() const
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<int>(b - t) : 0;
+    }
+
+    bool IsEmpty() const
+    {
+        return GetLength() == 0;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+// Binary indexed tree for sums. Because addition can be undone, a range is
+// the difference of two prefix sums and a point update is a delta, so it
+// needs half the memory of a segment tree and no identity padding.
+template <typename T>
+class FenwickTree
+{
+private:
+    std::vector<T> values;
+    std::vector<T> tree{T()};
+
+    static int LowBit(int index)
+    {
+        return index & -index;
+    }
+
+    T Prefix(int count) const
+    {
+        T sum = T();
+        for (; count > 0; count -= LowBit(count))
+        {
+            sum += tree[count];
+        }
+        return sum;
+    }
+
+public:
+    explicit FenwickTree(const std::plus<T> & = std::plus<T>()) {}
+
+    void Assign(const std::vector<T> &items)
+    {
+        values = items;
+        int size = static_cast<int>(values.size());
+        tree.assign(size + 1, T());
+        for (int i = 1; i <= size; ++i)
+        {
+            tree[i] += values[i - 1];
+            int parent = i + LowBit(i);
+            if (parent <= size)
+                tree[parent] += tree[i];
+        }
+    }
+
+    void PushBack(const T &value)
+    {
+        values.push_back(value);
+        int index = static_cast<int>(values.size());
+        tree.push_back(value + (Prefix(index - 1) - Prefix(index - LowBit(index))));
+    }
+
+    void Set(int index, const T &value)
+    {
+        T delta = value - values[index];
+        values[index] = value;
+        int size = static_cast<int>(values.size());
+        for (int i = index + 1; i <= size; i += LowBit(i))
+        {
+            tree[i] += delta;
+        }
+    }
+
+    const T &Get(int index) const
+    {
+        return values[index];
+    }
+
+    // Sum of the half-open range [first, last).
+    T Query(int first, int last) const
+    {
+        return Prefix(last) - Prefix(first);
+    }
+
+    T Total() const
+    {
+        return Prefix(static_cast<int>(values.size()));
+    }
+
+    std::vector<T> ToVector() const
+    {
+        return values;
+    }
+
+    int GetLength() const
+    {
+        return static_cast<int>(values.size());
+    }
+};
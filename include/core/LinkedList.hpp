@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 template <typename T>
@@ -13,6 +14,7 @@ public:
         Node *next;
 
         Node(const T &data) : data(data), next(nullptr) {}
+        Node(T &&data) : data(std::move(data)), next(nullptr) {}
     };
 
 private:
@@ -30,6 +32,34 @@ private:
         }
     }
 
+    void LinkBack(Node *newNode)
+    {
+        if (!head)
+        {
+            head = tail = newNode;
+        }
+        else
+        {
+            tail->next = newNode;
+            tail = newNode;
+        }
+        ++size;
+    }
+
+    void LinkFront(Node *newNode)
+    {
+        if (!head)
+        {
+            head = tail = newNode;
+        }
+        else
+        {
+            newNode->next = head;
+            head = newNode;
+        }
+        ++size;
+    }
+
 public:
     LinkedList() : head(nullptr), tail(nullptr), size(0) {}
 
@@ -49,6 +79,14 @@ public:
     }
 
 
+    LinkedList(LinkedList<T> &&other) noexcept
+        : head(other.head), tail(other.tail), size(other.size)
+    {
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size = 0;
+    }
+
     ~LinkedList()
     {
         Clear();
@@ -64,6 +102,21 @@ public:
         return *this;
     }
 
+    LinkedList<T> &operator=(LinkedList<T> &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Clear();
+            head = other.head;
+            tail = other.tail;
+            size = other.size;
+            other.head = nullptr;
+            other.tail = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
     void Clear()
     {
         Node *current = head;
@@ -117,32 +170,22 @@ public:
 
     void Append(const T &item)
     {
-        Node *newNode = new Node(item);
-        if (!head)
-        {
-            head = tail = newNode;
-        }
-        else
-        {
-            tail->next = newNode;
-            tail = newNode;
-        }
-        ++size;
+        LinkBack(new Node(item));
+    }
+
+    void Append(T &&item)
+    {
+        LinkBack(new Node(std::move(item)));
     }
 
     void Prepend(const T &item)
     {
-        Node *newNode = new Node(item);
-        if (!head)
-        {
-            head = tail = newNode;
-        }
-        else
-        {
-            newNode->next = head;
-            head = newNode;
-        }
-        ++size;
+        LinkFront(new Node(item));
+    }
+
+    void Prepend(T &&item)
+    {
+        LinkFront(new Node(std::move(item)));
     }
 
     void InsertAt(const T &item, int index)
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Free-list allocator for fixed-size nodes. Storage is carved out of chunks
+// that double in size and is only returned to the system when the pool is
+// destroyed. Not thread-safe; every node must be released before the pool
+// goes away, otherwise its destructor is never run.
+template <typename Node>
+class NodePool
+{
+private:
+    union Slot
+    {
+        Slot *next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    static constexpr int MAX_CHUNK_SIZE = 1 << 16;
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot *freeList = nullptr;
+    int chunkSize;
+    int liveCount = 0;
+
+    void Grow()
+    {
+        auto chunk = std::make_unique<Slot[]>(chunkSize);
+        for (int i = 0; i < chunkSize - 1; ++i)
+        {
+            chunk[i].next = &chunk[i + 1];
+        }
+        chunk[chunkSize - 1].next = freeList;
+        freeList = &chunk[0];
+        chunks.push_back(std::move(chunk));
+        chunkSize = std::min(chunkSize * 2, MAX_CHUNK_SIZE);
+    }
+
+public:
+    explicit NodePool(int initialChunkSize = 64) : chunkSize(initialChunkSize)
+    {
+        if (initialChunkSize <= 0)
+            throw std::invalid_argument("Chunk size must be positive");
+    }
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    template <typename... Args>
+    Node *Allocate(Args &&...args)
+    {
+        if (!freeList)
+            Grow();
+        Slot *slot = freeList;
+        Slot *next = slot->next;
+        Node *node = new (slot->storage) Node(std::forward<Args>(args)...);
+        freeList = next;
+        ++liveCount;
+        return node;
+    }
+
+    void Release(Node *node)
+    {
+        node->~Node();
+        Slot *slot = reinterpret_cast<Slot *>(node);
+        slot->next = freeList;
+        freeList = slot;
+        --liveCount;
+    }
+
+    int GetLiveCount() const
+    {
+        return liveCount;
+    }
+};
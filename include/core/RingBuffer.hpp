@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Growable circular buffer with O(1) push and pop at both ends. Capacity is
+// a power of two so positions wrap with a mask; items are constructed in
+// place, so T does not need a default constructor.
+template <typename T>
+class RingBuffer
+{
+private:
+    T *data = nullptr;
+    int capacity = 0;
+    int head = 0;
+    int size = 0;
+
+    static T *Allocate(int count)
+    {
+        return static_cast<T *>(::operator new(sizeof(T) * count, std::align_val_t(alignof(T))));
+    }
+
+    static void Deallocate(T *block)
+    {
+        ::operator delete(block, std::align_val_t(alignof(T)));
+    }
+
+    int Wrap(int index) const
+    {
+        return (head + index) & (capacity - 1);
+    }
+
+    void Grow(int minCapacity)
+    {
+        int newCapacity = capacity == 0 ? 8 : capacity;
+        while (newCapacity < minCapacity)
+            newCapacity *= 2;
+        if (newCapacity == capacity)
+            return;
+
+        T *newData = Allocate(newCapacity);
+        for (int i = 0; i < size; ++i)
+        {
+            T &item = data[Wrap(i)];
+            new (newData + i) T(std::move(item));
+            item.~T();
+        }
+        Deallocate(data);
+        data = newData;
+        capacity = newCapacity;
+        head = 0;
+    }
+
+    void CopyFrom(const RingBuffer &other)
+    {
+        Grow(other.size);
+        for (int i = 0; i < other.size; ++i)
+        {
+            new (data + i) T(other[i]);
+            ++size;
+        }
+    }
+
+public:
+    RingBuffer() = default;
+
+    explicit RingBuffer(int initialCapacity)
+    {
+        if (initialCapacity < 0)
+            throw std::invalid_argument("Capacity cannot be negative");
+        if (initialCapacity > 0)
+            Grow(initialCapacity);
+    }
+
+    RingBuffer(const RingBuffer &other)
+    {
+        CopyFrom(other);
+    }
+
+    RingBuffer(RingBuffer &&other) noexcept
+        : data(other.data), capacity(other.capacity), head(other.head), size(other.size)
+    {
+        other.data = nullptr;
+        other.capacity = 0;
+        other.head = 0;
+        other.size = 0;
+    }
+
+    RingBuffer &operator=(const RingBuffer &other)
+    {
+        if (this != &other)
+        {
+            Clear();
+            CopyFrom(other);
+        }
+        return *this;
+    }
+
+    RingBuffer &operator=(RingBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Clear();
+            Deallocate(data);
+            data = other.data;
+            capacity = other.capacity;
+            head = other.head;
+            size = other.size;
+            other.data = nullptr;
+            other.capacity = 0;
+            other.head = 0;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    ~RingBuffer()
+    {
+        Clear();
+        Deallocate(data);
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args)
+    {
+        if (size == capacity)
+            Grow(size + 1);
+        T *slot = new (data + Wrap(size)) T(std::forward<Args>(args)...);
+        ++size;
+        return *slot;
+    }
+
+    template <typename... Args>
+    T &EmplaceFront(Args &&...args)
+    {
+        if (size == capacity)
+            Grow(size + 1);
+        int slot = (head - 1) & (capacity - 1);
+        T *item = new (data + slot) T(std::forward<Args>(args)...);
+        head = slot;
+        ++size;
+        return *item;
+    }
+
+    void PushBack(const T &item)
+    {
+        EmplaceBack(item);
+    }
+
+    void PushBack(T &&item)
+    {
+        EmplaceBack(std::move(item));
+    }
+
+    void PushFront(const T &item)
+    {
+        EmplaceFront(item);
+    }
+
+    void PushFront(T &&item)
+    {
+        EmplaceFront(std::move(item));
+    }
+
+    T PopFront()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        T &slot = data[head];
+        T item = std::move(slot);
+        slot.~T();
+        head = Wrap(1);
+        --size;
+        return item;
+    }
+
+    T PopBack()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        T &slot = data[Wrap(size - 1)];
+        T item = std::move(slot);
+        slot.~T();
+        --size;
+        return item;
+    }
+
+    void DropFront()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        data[head].~T();
+        head = Wrap(1);
+        --size;
+    }
+
+    void DropBack()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        data[Wrap(size - 1)].~T();
+        --size;
+    }
+
+    T &Front()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        return data[head];
+    }
+
+    const T &Front() const
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        return data[head];
+    }
+
+    T &Back()
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        return data[Wrap(size - 1)];
+    }
+
+    const T &Back() const
+    {
+        if (size == 0)
+            throw std::out_of_range("RingBuffer is empty");
+        return data[Wrap(size - 1)];
+    }
+
+    T &operator[](int index)
+    {
+        if (index < 0 || index >= size)
+            throw std::out_of_range("Index out of range");
+        return data[Wrap(index)];
+    }
+
+    const T &operator[](int index) const
+    {
+        if (index < 0 || index >= size)
+            throw std::out_of_range("Index out of range");
+        return data[Wrap(index)];
+    }
+
+    void Reserve(int count)
+    {
+        if (count > capacity)
+            Grow(count);
+    }
+
+    void Clear()
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            data[Wrap(i)].~T();
+        }
+        head = 0;
+        size = 0;
+    }
+
+    int GetLength() const
+    {
+        return size;
+    }
+
+    int GetCapacity() const
+    {
+        return capacity;
+    }
+
+    bool IsEmpty() const
+    {
+        return size == 0;
+    }
+};
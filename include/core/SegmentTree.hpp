@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Associative operations usable with SegmentTree. An operation supplies its
+// identity through a static Identity(); std::plus and std::multiplies are
+// covered by RangeIdentity below.
+template <typename T>
+struct RangeMin
+{
+    T operator()(const T &a, const T &b) const { return b < a ? b : a; }
+    static T Identity() { return std::numeric_limits<T>::max(); }
+};
+
+template <typename T>
+struct RangeMax
+{
+    T operator()(const T &a, const T &b) const { return a < b ? b : a; }
+    static T Identity() { return std::numeric_limits<T>::lowest(); }
+};
+
+template <typename T, typename Op>
+struct RangeIdentity
+{
+    static T Value() { return Op::Identity(); }
+};
+
+template <typename T>
+struct RangeIdentity<T, std::plus<T>>
+{
+    static T Value() { return T(); }
+};
+
+template <typename T>
+struct RangeIdentity<T, std::multiplies<T>>
+{
+    static T Value() { return T(1); }
+};
+
+// Bottom-up segment tree over a power-of-two number of leaves: leaf i is at
+// capacity + i and unused leaves hold the identity. Op only has to be
+// associative; operands are always combined in index order.
+template <typename T, typename Op>
+class SegmentTree
+{
+private:
+    std::vector<T> tree;
+    int capacity = 0;
+    int size = 0;
+    Op op;
+
+    void Rebuild(int minCapacity)
+    {
+        std::vector<T> values(tree.begin() + capacity, tree.begin() + capacity + size);
+        Assign(values, minCapacity);
+    }
+
+    void Assign(const std::vector<T> &values, int minCapacity)
+    {
+        int newCapacity = 1;
+        while (newCapacity < minCapacity)
+            newCapacity *= 2;
+
+        capacity = newCapacity;
+        size = static_cast<int>(values.size());
+        tree.assign(2 * capacity, RangeIdentity<T, Op>::Value());
+        std::copy(values.begin(), values.end(), tree.begin() + capacity);
+        for (int node = capacity - 1; node >= 1; --node)
+        {
+            tree[node] = op(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+public:
+    explicit SegmentTree(const Op &op = Op()) : op(op)
+    {
+        Assign({}, 1);
+    }
+
+    void Assign(const std::vector<T> &values)
+    {
+        Assign(values, static_cast<int>(values.size()));
+    }
+
+    void PushBack(const T &value)
+    {
+        if (size == capacity)
+            Rebuild(capacity * 2);
+        Set(size++, value);
+    }
+
+    void Set(int index, const T &value)
+    {
+        int node = capacity + index;
+        tree[node] = value;
+        for (node /= 2; node >= 1; node /= 2)
+        {
+            tree[node] = op(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    const T &Get(int index) const
+    {
+        return tree[capacity + index];
+    }
+
+    // Reduction of the half-open range [first, last).
+    T Query(int first, int last) const
+    {
+        T left = RangeIdentity<T, Op>::Value();
+        T right = RangeIdentity<T, Op>::Value();
+        for (first += capacity, last += capacity; first < last; first /= 2, last /= 2)
+        {
+            if (first & 1)
+                left = op(left, tree[first++]);
+            if (last & 1)
+                right = op(tree[--last], right);
+        }
+        return op(left, right);
+    }
+
+    T Total() const
+    {
+        return tree[1];
+    }
+
+    std::vector<T> ToVector() const
+    {
+        return std::vector<T>(tree.begin() + capacity, tree.begin() + capacity + size);
+    }
+
+    int GetLength() const
+    {
+        return size;
+    }
+};
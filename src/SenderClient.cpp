@@ -1,46 +1,455 @@
 #include <iostream>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
+#include <iomanip>
+#include <random>
+#include <string>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include "include/Network/Framing.hpp"
+#include "include/SpecializedADT/LatencyHistogram.hpp"
 
-int main()
-{
-    const char *words[] = {"am", "i", "rushing", "or", "dragging"};
-    const int wordCount = sizeof(words) / sizeof(words[0]);
+using Clock = std::chrono::steady_clock;
 
-    int sock = 0;
-    struct sockaddr_in serv_addr;
-
-    if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+int Connect(int port)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
     {
         std::cerr << "Socket creation error" << std::endl;
         return -1;
     }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        std::cerr << "Connection Failed" << std::endl;
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
 
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(8080);
-
-    
-    if (inet_pton(AF_INET, "127.0.0.1", &serv_addr.sin_addr) <= 0)
+// Prints every message the server pushes for the subscribed topic.
+int Subscribe(int sock, const std::string &topic)
+{
+    std::string frame;
+    AppendTopicFrame(frame, FrameKind::Subscribe, topic);
+    if (send(sock, frame.data(), frame.size(), 0) < 0)
     {
-        std::cerr << "Invalid address / Address not supported" << std::endl;
+        std::cerr << "Send failed" << std::endl;
         return -1;
     }
+    std::cout << "Subscribed to " << topic << std::endl;
 
-    if (connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0)
+    ReceiveRing ring;
+    FrameDecoder decoder;
+    while (ring.FillFrom(sock) > 0)
     {
-        std::cerr << "Connection Failed" << std::endl;
+        FrameDecoder::Status status = decoder.Drain(ring, [](std::string_view payload)
+        {
+            TopicFrame delivery;
+            if (ParseTopicFrame(payload, delivery))
+                std::cout << "Received " << delivery.topic << "@" << delivery.offset << ": "
+                          << delivery.body << std::endl;
+        });
+        if (status != FrameDecoder::Status::NeedMore)
+            break;
+    }
+    std::cout << "Connection closed." << std::endl;
+    return 0;
+}
+
+// Message sizes for the load generator: "N" is fixed, "MIN-MAX" uniform
+// and "expMEAN" exponential with that mean, capped at 16 times it.
+struct SizeDistribution
+{
+    enum class Kind
+    {
+        Fixed,
+        Uniform,
+        Exponential
+    };
+    Kind kind = Kind::Fixed;
+    size_t low = 64;
+    size_t high = 64;
+
+    static bool Parse(const std::string &spec, SizeDistribution &sizes)
+    {
+        char *end = nullptr;
+        if (spec.compare(0, 3, "exp") == 0)
+        {
+            sizes.kind = Kind::Exponential;
+            sizes.low = std::strtoull(spec.c_str() + 3, &end, 10);
+            sizes.high = sizes.low * 16;
+            return *end == '\0' && sizes.low > 0;
+        }
+        sizes.low = sizes.high = std::strtoull(spec.c_str(), &end, 10);
+        sizes.kind = Kind::Fixed;
+        if (*end == '-')
+        {
+            sizes.kind = Kind::Uniform;
+            sizes.high = std::strtoull(end + 1, &end, 10);
+        }
+        return *end == '\0' && sizes.low <= sizes.high;
+    }
+
+    size_t Largest() const
+    {
+        return high;
+    }
+
+    size_t Next(std::mt19937_64 &random) const
+    {
+        if (kind == Kind::Uniform)
+            return std::uniform_int_distribution<size_t>(low, high)(random);
+        if (kind == Kind::Exponential)
+        {
+            double size = std::exponential_distribution<double>(1.0 / low)(random);
+            return std::min(static_cast<size_t>(size), high);
+        }
+        return low;
+    }
+};
+
+struct LoadOptions
+{
+    int port = 8080;
+    std::string topic = "load";
+    int connections = 1;
+    // Messages per second over all connections; zero sends as fast as the
+    // sockets take them.
+    double rate = 0;
+    double seconds = 10;
+    SizeDistribution sizes;
+    // Most messages handed to one send or writev.
+    int batch = 1;
+    bool writev = false;
+    bool noDelay = false;
+};
+
+struct LoadResult
+{
+    LatencyHistogram latency;
+    long long sent = 0;
+    long long acked = 0;
+    long long rejected = 0;
+    long long bytes = 0;
+    long long writes = 0;
+    // Messages that went out later than the schedule said, by a full
+    // millisecond or more.
+    long long late = 0;
+};
+
+bool WriteAll(int sock, std::vector<iovec> &spans)
+{
+    size_t first = 0;
+    while (first < spans.size())
+    {
+        int count = static_cast<int>(std::min<size_t>(spans.size() - first, IOV_MAX));
+        ssize_t written = ::writev(sock, spans.data() + first, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        size_t left = static_cast<size_t>(written);
+        while (first < spans.size() && left >= spans[first].iov_len)
+        {
+            left -= spans[first++].iov_len;
+        }
+        if (left > 0)
+        {
+            spans[first].iov_base = static_cast<char *>(spans[first].iov_base) + left;
+            spans[first].iov_len -= left;
+        }
+    }
+    return true;
+}
+
+// One connection of the load generator. The sender publishes on an
+// open-loop schedule, message i being due at start + i / rate, and tags each
+// message with its due time; the receiver turns every Ack into a latency
+// against that time, so a stalled server shows up in the histogram rather
+// than merely slowing the sender down.
+void RunConnection(const LoadOptions &options, int sock, int index, Clock::time_point start, LoadResult &result)
+{
+    const double rate = options.rate / options.connections;
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+    std::atomic<long long> sent{0};
+    std::atomic<bool> sending{true};
+
+    std::thread receiver([&]
+                         {
+                             timeval timeout{0, 200000};
+                             setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                             ReceiveRing ring(256 * 1024);
+                             FrameDecoder decoder;
+                             Clock::time_point deadline = end + std::chrono::seconds(5);
+                             while (sending.load() || result.acked + result.rejected < sent.load())
+                             {
+                                 if (Clock::now() > deadline)
+                                     break;
+                                 ssize_t count = ring.FillFrom(sock);
+                                 if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                                     continue;
+                                 if (count <= 0)
+                                     break;
+                                 long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                                 decoder.Drain(ring, [&](std::string_view payload)
+                                               {
+                                                   TopicFrame ack;
+                                                   uint64_t tag = 0;
+                                                   if (!ParseTopicFrame(payload, ack) || ack.kind != FrameKind::Ack ||
+                                                       DecodeVarint(ack.body, tag) == 0)
+                                                       return;
+                                                   if (ack.offset < 0)
+                                                       ++result.rejected;
+                                                   else
+                                                       ++result.acked;
+                                                   result.latency.Record(static_cast<uint64_t>(std::max(now - static_cast<long long>(tag), 0LL)));
+                                               });
+                             }
+                         });
+
+    std::mt19937_64 random(static_cast<uint64_t>(index) * 7919 + 1);
+    std::string payload(options.sizes.Largest(), 'x');
+    std::vector<char> headers(static_cast<size_t>(options.batch) * MAX_TOPIC_HEADER_BYTES);
+    std::vector<iovec> spans;
+    std::string frames;
+    long long count = 0;
+    while (true)
+    {
+        Clock::time_point now = Clock::now();
+        if (now >= end)
+            break;
+        long long due = options.batch;
+        if (rate > 0)
+        {
+            due = static_cast<long long>(std::chrono::duration<double>(now - start).count() * rate) + 1 - count;
+            if (due <= 0)
+            {
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(count / rate)));
+                continue;
+            }
+            due = std::min<long long>(due, options.batch);
+        }
+
+        spans.clear();
+        frames.clear();
+        for (long long i = 0; i < due; ++i)
+        {
+            Clock::duration scheduled = rate > 0
+                                            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((count + i) / rate))
+                                            : now - start;
+            if (now - start - scheduled >= std::chrono::milliseconds(1))
+                ++result.late;
+            long long tag = std::chrono::duration_cast<std::chrono::nanoseconds>(scheduled).count();
+            std::string_view body(payload.data(), options.sizes.Next(random));
+            result.bytes += static_cast<long long>(body.size());
+            if (options.writev)
+            {
+                char *header = headers.data() + i * MAX_TOPIC_HEADER_BYTES;
+                int headerSize = EncodeTopicHeader(header, FrameKind::Publish, options.topic, tag, body.size());
+                spans.push_back({header, static_cast<size_t>(headerSize)});
+                if (!body.empty())
+                    spans.push_back({const_cast<char *>(body.data()), body.size()});
+            }
+            else
+            {
+                AppendTopicFrame(frames, FrameKind::Publish, options.topic, body, tag);
+            }
+        }
+        if (!options.writev)
+            spans.push_back({frames.data(), frames.size()});
+        if (!WriteAll(sock, spans))
+        {
+            std::cerr << "Send failed on connection " << index << std::endl;
+            break;
+        }
+        ++result.writes;
+        count += due;
+        sent.store(count);
+    }
+    result.sent = count;
+    sending.store(false);
+    receiver.join();
+}
+
+int RunLoad(const LoadOptions &options)
+{
+    std::vector<int> sockets;
+    for (int i = 0; i < options.connections; ++i)
+    {
+        int sock = Connect(options.port);
+        if (sock < 0)
+            return -1;
+        if (options.noDelay)
+        {
+            int enable = 1;
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        sockets.push_back(sock);
+    }
+
+    std::vector<LoadResult> results(options.connections);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < options.connections; ++i)
+    {
+        threads.emplace_back([&, i] { RunConnection(options, sockets[i], i, start, results[i]); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    for (int sock : sockets)
+    {
+        close(sock);
+    }
+
+    LoadResult total;
+    for (const LoadResult &result : results)
+    {
+        total.latency.Merge(result.latency);
+        total.sent += result.sent;
+        total.acked += result.acked;
+        total.rejected += result.rejected;
+        total.bytes += result.bytes;
+        total.writes += result.writes;
+        total.late += result.late;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << options.connections << " connections, target "
+              << (options.rate > 0 ? std::to_string(static_cast<long long>(options.rate)) + " msg/s" : "unthrottled")
+              << ", " << options.seconds << " s, batch " << options.batch << (options.writev ? ", writev" : ", send")
+              << (options.noDelay ? ", TCP_NODELAY" : "") << '\n';
+    std::cout << "sent " << total.sent << " (" << total.sent / options.seconds << " msg/s, "
+              << total.bytes / options.seconds / (1024 * 1024) << " MiB/s of bodies, "
+              << static_cast<double>(total.sent) / std::max(total.writes, 1LL) << " msgs per write, "
+              << total.late << " late)\n";
+    std::cout << "acked " << total.acked << " (" << total.acked / elapsed << " msg/s), rejected "
+              << total.rejected << ", unacknowledged " << total.sent - total.acked - total.rejected << '\n';
+    if (total.latency.GetCount() == 0)
+        return total.sent == 0 ? 0 : 1;
+    auto micros = [&](double percentile) { return total.latency.GetValueAtPercentile(percentile) / 1000.0; };
+    std::cout << "latency us: min " << total.latency.GetMin() / 1000.0 << ", p50 " << micros(50)
+              << ", p90 " << micros(90) << ", p99 " << micros(99) << ", p999 " << micros(99.9)
+              << ", max " << total.latency.GetMax() / 1000.0 << ", mean " << total.latency.GetMean() / 1000
+              << std::endl;
+    return total.acked + total.rejected == total.sent ? 0 : 1;
+}
+
+// Usage: Client [port] [--newline] [--topic NAME] [--subscribe NAME]
+//        Client [port] --load [--topic NAME] [--connections N] [--rate MSGS]
+//               [--duration SECONDS] [--size N|MIN-MAX|expMEAN]
+//               [--batch N] [--writev] [--nodelay]
+// Publishes five words to the topic ("default" unless given), or with
+// --subscribe prints what is published to a topic. With --load it becomes a
+// load generator: every connection publishes to the topic ("load" unless
+// given) at its share of --rate messages per second, asks for an Ack for
+// each message, and the run ends with throughput and latency percentiles.
+int main(int argc, char **argv)
+{
+    const char *words[] = {"am", "i", "rushing", "or", "dragging"};
+    const int wordCount = sizeof(words) / sizeof(words[0]);
+
+    int port = 8080;
+    FramingMode framing = FramingMode::LengthPrefixed;
+    std::string topic;
+    std::string subscription;
+    bool load = false;
+    LoadOptions loadOptions;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--newline") == 0)
+            framing = FramingMode::NewlineDelimited;
+        else if (std::strcmp(argv[i], "--topic") == 0 && hasValue)
+            topic = argv[++i];
+        else if (std::strcmp(argv[i], "--subscribe") == 0 && hasValue)
+            subscription = argv[++i];
+        else if (std::strcmp(argv[i], "--load") == 0)
+            load = true;
+        else if (std::strcmp(argv[i], "--connections") == 0 && hasValue)
+            loadOptions.connections = std::max(std::atoi(argv[++i]), 1);
+        else if (std::strcmp(argv[i], "--rate") == 0 && hasValue)
+            loadOptions.rate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--duration") == 0 && hasValue)
+            loadOptions.seconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--batch") == 0 && hasValue)
+            loadOptions.batch = std::min(std::max(std::atoi(argv[++i]), 1), IOV_MAX / 2);
+        else if (std::strcmp(argv[i], "--writev") == 0)
+            loadOptions.writev = true;
+        else if (std::strcmp(argv[i], "--nodelay") == 0)
+            loadOptions.noDelay = true;
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+        {
+            if (!SizeDistribution::Parse(argv[++i], loadOptions.sizes))
+            {
+                std::cerr << "Invalid size distribution: " << argv[i] << std::endl;
+                return -1;
+            }
+        }
+        else
+            port = std::atoi(argv[i]);
+    }
+
+    if (load)
+    {
+        if (framing == FramingMode::NewlineDelimited)
+        {
+            std::cerr << "Load mode needs length-prefixed frames for acks" << std::endl;
+            return -1;
+        }
+        loadOptions.port = port;
+        if (!topic.empty())
+            loadOptions.topic = topic;
+        return RunLoad(loadOptions);
+    }
+    if (topic.empty())
+        topic = "default";
+
+    int sock = Connect(port);
+    if (sock < 0)
         return -1;
+
+    if (!subscription.empty())
+    {
+        int result = Subscribe(sock, subscription);
+        close(sock);
+        return result;
     }
 
     std::cout << "Connected to server. Sending words every 5 seconds..." << std::endl;
 
+    std::string frame;
     for (int i = 0; i < wordCount; ++i)
     {
-        send(sock, words[i], strlen(words[i]), 0);
+        frame.clear();
+        if (framing == FramingMode::NewlineDelimited)
+            AppendFrame(frame, words[i], framing);
+        else
+            AppendTopicFrame(frame, FrameKind::Publish, topic, words[i]);
+        if (send(sock, frame.data(), frame.size(), 0) < 0)
+        {
+            std::cerr << "Send failed" << std::endl;
+            break;
+        }
         std::cout << "Sent: " << words[i] << std::endl;
         std::this_thread::sleep_for(std::chrono::seconds(5));
     }
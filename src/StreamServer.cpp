@@ -1,89 +1,123 @@
+#include <csignal>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
-#include <cstring>
 #include <string>
-#include "include/SpecializedADT/Stream.hpp"
+#include <vector>
+#include "include/Network/Broker.hpp"
 
-
-void PortPolling()
+// Usage: Server [port] [loops] [--newline] [--retain-count N]
+//               [--retain-bytes N] [--retain-seconds N]
+//               [--spill DIRECTORY] [--segment-bytes N] [--group N]
+//               [--high-watermark N] [--low-watermark N] [--uring]
+//               [--topic NAME=COUNT]...
+// Clients publish to and subscribe to named topics (see Framing.hpp); with
+// --newline every line is published to the topic "default". By default a
+// topic keeps its newest 256 MiB of messages; the retention flags change
+// that for every topic, and --topic creates a topic that keeps its newest
+// COUNT messages instead (COUNT must be positive). With --spill every message is also written to
+// segment files under DIRECTORY/<topic> and the retention limits only bound
+// what stays in memory; older offsets are sent to subscribers from disk.
+// --group N publishes messages N at a time, or at the next heartbeat.
+// --high-watermark N pauses reading from a publisher once a topic's slowest
+// subscriber is N messages behind, until it is back within --low-watermark
+// (default N / 2). --uring receives through io_uring with
+// multishot receives where the kernel supports it, epoll otherwise.
+int main(int argc, char **argv)
 {
-    BufferedStream<std::string> MessageBuffer;
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd == 0)
+    Broker::Options options;
+    options.retention.maxBytes = 256u * 1024 * 1024;
+    std::vector<std::pair<std::string, int>> topics;
+    int position = 0;
+    for (int i = 1; i < argc; ++i)
     {
-        perror("socket failed");
-        exit(EXIT_FAILURE);
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--newline")
+            options.server.framing = FramingMode::NewlineDelimited;
+        else if (argument == "--retain-count" && hasValue)
+            options.retention.maxCount = std::atoi(argv[++i]);
+        else if (argument == "--retain-bytes" && hasValue)
+            options.retention.maxBytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--retain-seconds" && hasValue)
+            options.retention.maxAge = std::chrono::seconds(std::atoi(argv[++i]));
+        else if (argument == "--spill" && hasValue)
+            options.spillDirectory = argv[++i];
+        else if (argument == "--segment-bytes" && hasValue)
+            options.segmentBytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--group" && hasValue)
+            options.groupCommit = std::max(std::atoi(argv[++i]), 1);
+        else if (argument == "--high-watermark" && hasValue)
+            options.highWatermark = std::atoi(argv[++i]);
+        else if (argument == "--low-watermark" && hasValue)
+            options.lowWatermark = std::atoi(argv[++i]);
+        else if (argument == "--uring")
+            options.server.backend = ReceiveBackend::IoUring;
+        else if (argument == "--topic" && hasValue)
+        {
+            std::string topic = argv[++i];
+            size_t separator = topic.find('=');
+            int count = separator == std::string::npos ? 0 : std::atoi(topic.c_str() + separator + 1);
+            // A count of zero would mean no limit at all, not a small one.
+            if (count <= 0)
+            {
+                std::cerr << "--topic expects NAME=COUNT with a positive COUNT, got " << topic << std::endl;
+                return EXIT_FAILURE;
+            }
+            topics.emplace_back(topic.substr(0, separator), count);
+        }
+        else if (position++ == 0)
+            options.server.port = std::atoi(argv[i]);
+        else
+            options.server.loops = std::atoi(argv[i]);
     }
 
-    struct sockaddr_in address;
-    int opt = 1;
-    int addrlen = sizeof(address);
-
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
+    // A client that disconnects while a write to it is in flight must not
+    // take the server down.
+    std::signal(SIGPIPE, SIG_IGN);
 
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(8080);
-
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0)
-    {
-        perror("bind failed");
-        exit(EXIT_FAILURE);
-    }
-    if (listen(server_fd, 3) < 0)
+    std::unique_ptr<Broker> broker;
+    try
     {
-        perror("listen");
-        exit(EXIT_FAILURE);
-    }
-
-    int new_socket = accept(server_fd, (struct sockaddr *)&address, (socklen_t *)&addrlen);
-    if (new_socket < 0)
-    {
-        perror("accept");
-        exit(EXIT_FAILURE);
-    }
-    char buffer[1024];
-
-    while (true)
-    {   
-
-        memset(buffer, 0, sizeof(buffer));
-        int valread = read(new_socket, buffer, sizeof(buffer));
-
-        if (valread == 0)
-        {
-            printf("Client disconnected.\n");
-            break;
-        }
-        if (valread < 0)
+        broker = std::make_unique<Broker>(options);
+        for (const auto &topic : topics)
         {
-            perror("read error");
-            break;
+            RetentionPolicy retention;
+            retention.maxCount = topic.second;
+            broker->CreateTopic(topic.first, retention);
         }
-        std::string Message(buffer, valread);
-
-        MessageBuffer.SetCurrent(Message);
-
-        std::cout << "[SERVER] Stream got new element and set to current: " << MessageBuffer.GetCurrent().value() <<"\n";
-        MessageBuffer.CommitCurrentToBuffer();
-        std::cout << "[SERVER] Stream commited new element to buffer" << "\n";
+        broker->Start();
+        std::cout << "Receiving through "
+                  << (broker->GetServerBackend() == ReceiveBackend::IoUring ? "io_uring" : "epoll") << std::endl;
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << "Failed to start server: " << error.what() << std::endl;
+        return EXIT_FAILURE;
     }
-}
-
-
-int main()
-{
-    std::thread monitor(PortPolling);
-    monitor.detach();
 
     while (true)
     {
-        std::cout << "[MAIN THREAD] основной поток работает" << '\n';
+        broker->Flush();
+        StreamServer::Stats server = broker->GetServerStats();
+        Broker::Stats stats = broker->GetStats();
+        std::cout << "[MAIN THREAD] основной поток работает: connections "
+                  << server.accepted - server.closed << ", published " << stats.published
+                  << ", delivered " << stats.delivered << " in " << stats.writes << " writes"
+                  << ", acked " << stats.acknowledged << ", rejected " << stats.rejected << ", publishers paused " << server.pauses
+                  << " times for " << server.pausedMicroseconds / 1000 << " ms, "
+                  << static_cast<double>(server.waits + server.receiveCalls) / std::max(server.messages, 1LL)
+                  << " receive syscalls per message" << '\n';
+        broker->ForEachTopic(
+            [](const std::string &name, const Broker::Stream &stream)
+            {
+                std::cout << "    topic " << name << ": retained offsets [" << stream.GetFirstOffset()
+                          << ", " << stream.GetNextOffset() << ")";
+                if (stream.GetLog())
+                    std::cout << ", on disk from " << stream.GetOldestOffset();
+                std::cout << '\n';
+            });
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-}
\ No newline at end of file
+}
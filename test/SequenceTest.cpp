@@ -1,5 +1,17 @@
 #include <cassert>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <filesystem>
+#include <fstream>
+#include <sys/resource.h>
+#include <cstdlib>
 #include "include/Muttable/Array/ArrayMutableSequence.hpp"
 #include "include/Muttable/List/ListMutableSequence.hpp"
 #include "include/Immutable/Array/ArrayImmutableSequence.hpp"
@@ -8,6 +20,26 @@
 
 #include "include/SpecializedADT/Queue.hpp"
 #include "include/SpecializedADT/Deque.hpp"
+#include "include/SpecializedADT/PriorityDeque.hpp"
+#include "include/SpecializedADT/IndexedPriorityQueue.hpp"
+#include "include/SpecializedADT/RadixHeap.hpp"
+#include "include/SpecializedADT/BucketQueue.hpp"
+#include "include/SpecializedADT/PairingHeap.hpp"
+#include "include/SpecializedADT/SpscRingQueue.hpp"
+#include "include/SpecializedADT/MpmcQueue.hpp"
+#include "include/SpecializedADT/WorkStealingDeque.hpp"
+#include "include/SpecializedADT/ConcurrentSegmentedDeque.hpp"
+#include "include/SpecializedADT/ConcurrentLogSequence.hpp"
+#include "include/SpecializedADT/SnapshotCell.hpp"
+#include "include/SpecializedADT/MonotonicDeque.hpp"
+#include "include/SpecializedADT/SlidingWindow.hpp"
+#include "include/SpecializedADT/TimerWheel.hpp"
+#include "include/SpecializedADT/RangeQuerySequence.hpp"
+#include "include/Network/StreamServer.hpp"
+#include "include/Network/Broker.hpp"
+#include "include/SpecializedADT/Stream.hpp"
+#include "include/SpecializedADT/SegmentLog.hpp"
+#include "include/SpecializedADT/LatencyHistogram.hpp"
 
 void TestArrayMutableSequence()
 {
@@ -263,6 +295,95 @@ void TestListImmutableSequence()
     std::cout << "ListImmutableSequence tests passed!" << std::endl;
 }
 
+// Counts copies, so a test can tell a moved push from a copied one.
+struct CopyCounted
+{
+    static inline int copies = 0;
+    std::string value;
+
+    CopyCounted() = default;
+    explicit CopyCounted(std::string value) : value(std::move(value)) {}
+    CopyCounted(const CopyCounted &other) : value(other.value) { ++copies; }
+    CopyCounted(CopyCounted &&other) = default;
+    CopyCounted &operator=(const CopyCounted &other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    CopyCounted &operator=(CopyCounted &&other) = default;
+};
+
+// Rvalue pushes reach the backend without a copy.
+template <template <typename> class Storage>
+void CheckStorageMoves()
+{
+    CopyCounted::copies = 0;
+    Deque<CopyCounted, Storage<CopyCounted>> deque;
+    for (int i = 0; i < 100; ++i)
+    {
+        deque.PushBack(CopyCounted(std::to_string(i)));
+        deque.PushFront(CopyCounted(std::to_string(-i)));
+    }
+    assert(deque.PopFront().value == "-99" && deque.PopBack().value == "99");
+    assert(CopyCounted::copies == 0);
+}
+
+template <typename Storage>
+void CheckDequeStorage()
+{
+    Deque<std::string, Storage> deque;
+    for (int i = 0; i < 100; ++i)
+    {
+        deque.PushBack(std::to_string(i));
+        deque.PushFront(std::to_string(-i));
+    }
+    assert(deque.GetLength() == 200);
+    assert(deque.PeekFront() == "-99");
+    assert(deque.PeekBack() == "99");
+
+    Deque<std::string, Storage> copy(deque);
+    for (int i = 99; i >= 0; --i)
+    {
+        assert(deque.PopFront() == std::to_string(-i));
+    }
+    for (int i = 99; i >= 50; --i)
+    {
+        assert(deque.PopBack() == std::to_string(i));
+    }
+    assert(deque.GetLength() == 50);
+    assert(copy.GetLength() == 200);
+
+    Deque<std::string, Storage> moved(std::move(copy));
+    assert(moved.GetLength() == 200);
+    assert(moved.PeekBack() == "99");
+    const std::string &front = moved.PeekFront();
+    const std::string &back = moved.PeekBack();
+    assert(front == "-99" && back == "99");
+    assert(copy.GetLength() == 0);
+    copy.PushBack("again");
+    assert(copy.GetLength() == 1 && copy.PeekFront() == "again");
+    deque = std::move(moved);
+    assert(deque.GetLength() == 200);
+    assert(deque.PopFront() == "-99");
+
+    Queue<std::string, Storage> queue;
+    for (int i = 0; i < 100; ++i)
+    {
+        queue.Enqueue(std::to_string(i));
+        if (i % 3 == 0)
+            assert(queue.Dequeue() == std::to_string(i / 3));
+    }
+    Queue<std::string, Storage> queueCopy = queue;
+    assert(queueCopy.GetLength() == queue.GetLength());
+    for (int i = 34; i < 100; ++i)
+    {
+        assert(queue.Dequeue() == std::to_string(i));
+    }
+    assert(queue.IsEmpty());
+    assert(queueCopy.Peek() == "34");
+}
+
 void TestQueue()
 {
     std::cout << "Testing Queue..." << std::endl;
@@ -373,9 +494,2391 @@ void TestDeque()
     assert(deque.PopFront() == 3);
     assert(deque.IsEmpty());
 
+    CheckDequeStorage<RingStorage<std::string>>();
+    CheckDequeStorage<ArrayStorage<std::string>>();
+    CheckDequeStorage<SegmentedStorage<std::string>>();
+    CheckDequeStorage<ListStorage<std::string>>();
+    CheckDequeStorage<VirtualStorage<std::string>>();
+    CheckStorageMoves<RingStorage>();
+    CheckStorageMoves<ArrayStorage>();
+    CheckStorageMoves<SegmentedStorage>();
+    CheckStorageMoves<ListStorage>();
+
     std::cout << "Deque tests passed!" << std::endl;
 }
 
+void TestPriorityQueue()
+{
+    std::cout << "Testing PriorityQueue..." << std::endl;
+    PriorityQueue<int> queue;
+
+    assert(queue.IsEmpty());
+    try
+    {
+        queue.Dequeue();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    queue.Enqueue(5);
+    queue.Enqueue(1);
+    queue.Enqueue(9);
+    queue.Enqueue(3);
+    assert(queue.GetLength() == 4);
+    assert(queue.Peek() == 9);
+    assert(queue.Dequeue() == 9);
+    assert(queue.Dequeue() == 5);
+
+    int items[] = {7, 2, 8, 4, 6, 0, 11, 10};
+    queue.PushRange(items, items + 8);
+    assert(queue.GetLength() == 10);
+    int previous = queue.Dequeue();
+    while (!queue.IsEmpty())
+    {
+        int current = queue.Dequeue();
+        assert(current <= previous);
+        previous = current;
+    }
+
+    PriorityQueue<int, std::greater<int>, 2> minQueue(items, 8);
+    assert(minQueue.Peek() == 0);
+    minQueue.Emplace(-3);
+    assert(minQueue.Dequeue() == -3);
+    assert(minQueue.Dequeue() == 0);
+    assert(minQueue.Dequeue() == 2);
+    assert(minQueue.GetLength() == 6);
+
+    std::cout << "PriorityQueue tests passed!" << std::endl;
+}
+
+void TestPriorityDeque()
+{
+    std::cout << "Testing PriorityDeque..." << std::endl;
+    int items[] = {7, 2, 8, 4, 6, 0, 11, 10, 3};
+    PriorityDeque<int> deque(items, 9);
+
+    assert(deque.GetLength() == 9);
+    assert(deque.PeekMin() == 0);
+    assert(deque.PeekMax() == 11);
+
+    assert(deque.PopMax() == 11);
+    assert(deque.PopMin() == 0);
+    assert(deque.PopMax() == 10);
+    assert(deque.PopMin() == 2);
+
+    deque.Enqueue(1);
+    deque.Enqueue(20);
+    assert(deque.PeekMin() == 1);
+    assert(deque.PeekMax() == 20);
+    assert(deque.GetLength() == 7);
+
+    int previous = deque.PopMin();
+    while (!deque.IsEmpty())
+    {
+        int current = deque.PopMin();
+        assert(current >= previous);
+        previous = current;
+    }
+    try
+    {
+        deque.PopMax();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    PriorityDeque<int> topK(3);
+    for (int item : items)
+    {
+        topK.Enqueue(item);
+    }
+    assert(topK.GetLength() == 3);
+    assert(!topK.Enqueue(5));
+    assert(topK.PopMin() == 8);
+    assert(topK.PopMin() == 10);
+    assert(topK.PopMin() == 11);
+
+    std::cout << "PriorityDeque tests passed!" << std::endl;
+}
+
+void TestIndexedPriorityQueue()
+{
+    std::cout << "Testing IndexedPriorityQueue..." << std::endl;
+    IndexedPriorityQueue<int, std::greater<int>> queue;
+
+    auto a = queue.Enqueue(50);
+    auto b = queue.Enqueue(20);
+    auto c = queue.Enqueue(40);
+    auto d = queue.Enqueue(30);
+    assert(queue.GetLength() == 4);
+    assert(queue.Peek() == 20);
+    assert(queue.Contains(a) && queue.Contains(d));
+
+    queue.UpdatePriority(a, 10);
+    assert(queue.Peek() == 10);
+    assert(queue.Get(a) == 10);
+
+    queue.UpdatePriority(a, 45);
+    assert(queue.Peek() == 20);
+
+    assert(queue.Remove(c) == 40);
+    assert(!queue.Contains(c));
+    try
+    {
+        queue.Remove(c);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    auto e = queue.Enqueue(35);
+    assert(!queue.Contains(c));
+    assert(queue.Contains(e));
+
+    assert(queue.Dequeue() == 20);
+    assert(!queue.Contains(b));
+    assert(queue.Dequeue() == 30);
+    assert(queue.Dequeue() == 35);
+    assert(queue.Dequeue() == 45);
+    assert(queue.IsEmpty());
+
+    std::cout << "IndexedPriorityQueue tests passed!" << std::endl;
+}
+
+void TestRadixHeap()
+{
+    std::cout << "Testing RadixHeap..." << std::endl;
+    RadixHeap<unsigned, std::string> heap;
+
+    assert(heap.IsEmpty());
+    heap.Enqueue(40, "d");
+    heap.Enqueue(10, "a");
+    heap.Enqueue(30, "c");
+    heap.Enqueue(20, "b");
+    assert(heap.GetLength() == 4);
+    assert(heap.Peek().first == 10);
+
+    auto top = heap.Dequeue();
+    assert(top.first == 10 && top.second == "a");
+    heap.Enqueue(15, "e");
+    try
+    {
+        heap.Enqueue(5, "x");
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    assert(heap.Dequeue().second == "e");
+    assert(heap.Dequeue().second == "b");
+    assert(heap.Dequeue().second == "c");
+    assert(heap.Dequeue().second == "d");
+    assert(heap.IsEmpty());
+
+    // Peeking takes nothing out, so a key between the last extracted one
+    // and the peeked minimum is still accepted, as when Dijkstra relaxes an
+    // edge after looking at the next vertex.
+    heap.Enqueue(64, "p");
+    assert(heap.Peek().first == 64 && heap.GetLastKey() == 40);
+    heap.Enqueue(41, "q");
+    assert(heap.Peek().first == 41);
+    assert(heap.Dequeue().second == "q" && heap.Dequeue().second == "p");
+
+    RadixHeap<unsigned, int> numbers;
+    std::map<unsigned, int> expected;
+    unsigned floor = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        unsigned key = floor + (i * 7919u) % 97;
+        numbers.Enqueue(key, 0);
+        ++expected[key];
+        if (i % 3 == 0)
+            assert(numbers.Peek().first == expected.begin()->first);
+        if (i % 2 == 0)
+        {
+            unsigned taken = numbers.Dequeue().first;
+            assert(taken == expected.begin()->first);
+            if (--expected.begin()->second == 0)
+                expected.erase(expected.begin());
+            floor = taken;
+        }
+    }
+    while (!numbers.IsEmpty())
+    {
+        assert(numbers.Dequeue().first == expected.begin()->first);
+        if (--expected.begin()->second == 0)
+            expected.erase(expected.begin());
+    }
+
+    std::cout << "RadixHeap tests passed!" << std::endl;
+}
+
+void TestBucketQueue()
+{
+    std::cout << "Testing BucketQueue..." << std::endl;
+    BucketQueue<unsigned, int> queue(10);
+
+    queue.Enqueue(3, 30);
+    queue.Enqueue(1, 10);
+    queue.Enqueue(7, 70);
+    assert(queue.GetLength() == 3);
+    assert(queue.Peek().second == 10);
+    assert(queue.Dequeue().first == 1);
+
+    queue.Enqueue(10, 100);
+    try
+    {
+        queue.Enqueue(11, 110);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    assert(queue.Dequeue().second == 30);
+    assert(queue.Dequeue().second == 70);
+    assert(queue.Dequeue().second == 100);
+    assert(queue.IsEmpty());
+    try
+    {
+        queue.Dequeue();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    // Once drained, the queue accepts a key beyond its old window, which
+    // then starts the new one.
+    queue.Enqueue(25, 250);
+    queue.Enqueue(34, 340);
+    try
+    {
+        queue.Enqueue(24, 240);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    assert(queue.Dequeue().second == 250);
+    assert(queue.Dequeue().second == 340);
+    queue.Enqueue(5, 50);
+    assert(queue.Dequeue().first == 5 && queue.IsEmpty());
+
+    std::cout << "BucketQueue tests passed!" << std::endl;
+}
+
+void TestPairingHeap()
+{
+    std::cout << "Testing PairingHeap..." << std::endl;
+    auto pool = std::make_shared<PairingHeap<int>::Pool>();
+    PairingHeap<int> first(pool);
+    PairingHeap<int> second(pool);
+
+    assert(first.IsEmpty());
+    try
+    {
+        first.Dequeue();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        first.Enqueue(i);
+        second.Enqueue(i + 1);
+    }
+    assert(first.Peek() == 98);
+    assert(second.Peek() == 99);
+
+    first.Meld(second);
+    assert(second.IsEmpty());
+    assert(first.GetLength() == 100);
+    assert(pool->GetLiveCount() == 100);
+    for (int i = 99; i >= 90; --i)
+    {
+        assert(first.Dequeue() == i);
+    }
+
+    PairingHeap<int> other;
+    other.Enqueue(500);
+    other.Enqueue(-5);
+    first.Meld(other);
+    assert(other.IsEmpty());
+    assert(first.GetLength() == 92);
+    assert(first.Dequeue() == 500);
+
+    int previous = first.Dequeue();
+    while (!first.IsEmpty())
+    {
+        int current = first.Dequeue();
+        assert(current <= previous);
+        previous = current;
+    }
+    assert(previous == -5);
+    assert(pool->GetLiveCount() == 0);
+
+    // A default heap owns its pool, so it can be handed to another thread.
+    // Heaps that ask for the thread's shared pool meld without copying;
+    // another thread's shared pool is a different one.
+    PairingHeap<int> own;
+    PairingHeap<int> separate;
+    assert(own.GetPool() != separate.GetPool());
+    own.Enqueue(4);
+    std::thread([&] {
+        PairingHeap<int> moved(std::move(own));
+        assert(moved.Dequeue() == 4 && moved.GetPool()->GetLiveCount() == 0);
+    }).join();
+
+    PairingHeap<int> left(PairingHeap<int>::ThreadPool());
+    PairingHeap<int> right(PairingHeap<int>::ThreadPool());
+    assert(left.GetPool() == right.GetPool() && left.GetPool() != pool);
+    int live = left.GetPool()->GetLiveCount();
+    left.Enqueue(1);
+    right.Enqueue(2);
+    right.Enqueue(3);
+    const int *top = &right.Peek();
+    left.Meld(right);
+    assert(&left.Peek() == top && left.GetLength() == 3 && right.IsEmpty());
+    assert(left.GetPool()->GetLiveCount() == live + 3);
+    std::thread([&] { assert(PairingHeap<int>::ThreadPool() != left.GetPool()); }).join();
+
+    std::cout << "PairingHeap tests passed!" << std::endl;
+}
+
+void TestSpscRingQueue()
+{
+    std::cout << "Testing SpscRingQueue..." << std::endl;
+    SpscRingQueue<std::string> queue(3);
+
+    assert(queue.GetCapacity() == 4);
+    assert(queue.IsEmpty());
+    assert(queue.TryFront() == nullptr);
+
+    assert(queue.TryPush("a"));
+    assert(queue.TryEmplace(3, 'b'));
+    std::string batch[] = {"c", "d", "e"};
+    assert(queue.TryPushN(batch, 3) == 2);
+    assert(!queue.TryPush("f"));
+    assert(queue.GetLength() == 4);
+
+    assert(*queue.TryFront() == "a");
+    queue.Pop();
+    std::string item;
+    assert(queue.TryPop(item) && item == "bbb");
+
+    std::string out[4];
+    assert(queue.TryPopN(out, 4) == 2);
+    assert(out[0] == "c" && out[1] == "d");
+    assert(!queue.TryPop(item));
+    assert(queue.TryPushN(batch, 0) == 0 && queue.TryPopN(out, 0) == 0);
+    try
+    {
+        queue.TryPushN(batch, -1);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    assert(queue.TryPush("g"));
+    try
+    {
+        queue.TryPopN(out, -1);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    assert(queue.GetLength() == 1);
+
+    const int count = 100000;
+    SpscRingQueue<int> numbers(64);
+    std::thread producer([&] {
+        for (int i = 0; i < count; ++i)
+        {
+            while (!numbers.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+    for (int expected = 0; expected < count; ++expected)
+    {
+        int value;
+        while (!numbers.TryPop(value))
+            std::this_thread::yield();
+        assert(value == expected);
+    }
+    producer.join();
+    assert(numbers.IsEmpty());
+
+    std::cout << "SpscRingQueue tests passed!" << std::endl;
+}
+
+void TestMpmcQueue()
+{
+    std::cout << "Testing MpmcQueue..." << std::endl;
+    MpmcQueue<std::string> queue(4);
+
+    assert(queue.GetCapacity() == 4);
+    assert(queue.IsEmpty());
+    std::string item;
+    assert(!queue.TryDequeue(item));
+
+    assert(queue.TryEnqueue("a"));
+    assert(queue.TryEnqueue("b"));
+    assert(queue.TryEmplace(2, 'c'));
+    assert(queue.TryEnqueue("d"));
+    assert(!queue.TryEnqueue("e"));
+    assert(queue.GetLength() == 4);
+
+    assert(queue.TryDequeue(item) && item == "a");
+    assert(queue.Dequeue(item) && item == "b");
+
+    queue.Close();
+    assert(queue.IsClosed());
+    assert(!queue.TryEnqueue("f"));
+    assert(!queue.Enqueue("f"));
+    assert(queue.Dequeue(item) && item == "cc");
+    assert(queue.Dequeue(item) && item == "d");
+    assert(!queue.Dequeue(item));
+
+    const int producers = 4;
+    const int perProducer = 20000;
+    MpmcQueue<int> numbers(16);
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(3, 0);
+    for (int c = 0; c < 3; ++c)
+    {
+        threads.emplace_back([&, c] {
+            int value;
+            while (numbers.Dequeue(value))
+                sums[c] += value;
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p)
+    {
+        senders.emplace_back([&] {
+            for (int i = 1; i <= perProducer; ++i)
+                assert(numbers.Enqueue(i));
+        });
+    }
+    for (auto &sender : senders)
+        sender.join();
+    numbers.Close();
+    for (auto &thread : threads)
+        thread.join();
+    assert(sums[0] + sums[1] + sums[2] == producers * (perProducer * (perProducer + 1LL) / 2));
+
+    // A producer that has claimed a cell but not yet filled it when the
+    // queue closes: its Enqueue succeeds, so Dequeue must wait for the item.
+    struct Slow
+    {
+        int value = 0;
+        Slow() = default;
+        explicit Slow(int value) : value(value) {}
+        Slow(Slow &&other) : value(other.value)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        Slow &operator=(Slow &&other) = default;
+    };
+    MpmcQueue<Slow> slow(2);
+    std::atomic<bool> enqueued{false};
+    std::thread producer([&] { enqueued.store(slow.Enqueue(Slow(7))); });
+    while (slow.GetLength() == 0)
+        std::this_thread::yield();
+    slow.Close();
+    Slow received;
+    assert(slow.Dequeue(received) && received.value == 7);
+    assert(!slow.Dequeue(received));
+    producer.join();
+    assert(enqueued.load());
+
+    std::cout << "MpmcQueue tests passed!" << std::endl;
+}
+
+void TestWorkStealingDeque()
+{
+    std::cout << "Testing WorkStealingDeque..." << std::endl;
+    WorkStealingDeque<int> deque(2);
+
+    int item;
+    assert(deque.IsEmpty());
+    assert(!deque.PopBottom(item));
+    assert(!deque.Steal(item));
+
+    for (int i = 0; i < 10; ++i)
+        deque.PushBottom(i);
+    assert(deque.GetLength() == 10);
+    assert(deque.PopBottom(item) && item == 9);
+    assert(deque.Steal(item) && item == 0);
+    assert(deque.Steal(item) && item == 1);
+    assert(deque.PopBottom(item) && item == 8);
+    assert(deque.GetLength() == 6);
+
+    while (deque.PopBottom(item))
+    {
+    }
+    assert(deque.IsEmpty());
+
+    const int count = 200000;
+    const int thieves = 3;
+    std::vector<std::atomic<int>> seen(count);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t)
+    {
+        threads.emplace_back([&] {
+            int stolen;
+            while (!done.load())
+            {
+                if (deque.Steal(stolen))
+                    seen[stolen].fetch_add(1);
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        deque.PushBottom(i);
+        if (i % 3 != 0)
+            continue;
+        // A pop that loses the last item to a thief leaves `item` as it was.
+        item = -1;
+        if (deque.PopBottom(item))
+            seen[item].fetch_add(1);
+        else
+            assert(item == -1);
+    }
+    while (deque.PopBottom(item))
+        seen[item].fetch_add(1);
+    done.store(true);
+    for (auto &thread : threads)
+        thread.join();
+    for (int i = 0; i < count; ++i)
+        assert(seen[i].load() == 1);
+
+    std::cout << "WorkStealingDeque tests passed!" << std::endl;
+}
+
+void TestConcurrentSegmentedDeque()
+{
+    std::cout << "Testing ConcurrentSegmentedDeque..." << std::endl;
+    ConcurrentSegmentedDeque<std::string> deque;
+
+    std::string item;
+    assert(deque.IsEmpty());
+    assert(!deque.TryPopFront(item));
+    assert(!deque.TryPopBack(item));
+
+    deque.PushBack("B");
+    deque.PushFront("A");
+    deque.PushBack("C");
+    assert(deque.GetLength() == 3);
+    assert(deque.TryPopFront(item) && item == "A");
+    assert(deque.TryPopBack(item) && item == "C");
+    assert(deque.TryPopBack(item) && item == "B");
+    assert(deque.IsEmpty());
+
+    ConcurrentSegmentedDeque<int> numbers;
+    for (int i = 0; i < 1000; ++i)
+    {
+        numbers.PushBack(i);
+        numbers.PushFront(-i - 1);
+    }
+    int value;
+    for (int i = 1000; i > 0; --i)
+    {
+        assert(numbers.TryPopFront(value) && value == -i);
+    }
+    for (int i = 999; i >= 0; --i)
+    {
+        assert(numbers.TryPopBack(value) && value == i);
+    }
+    assert(numbers.IsEmpty());
+
+    const int producers = 2;
+    const int perProducer = 50000;
+    const int total = producers * perProducer;
+    std::vector<std::atomic<int>> seen(total);
+    std::atomic<int> received{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < perProducer; ++i)
+            {
+                if (i % 2 == 0)
+                    numbers.PushBack(p * perProducer + i);
+                else
+                    numbers.PushFront(p * perProducer + i);
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++c)
+    {
+        threads.emplace_back([&, c] {
+            int taken;
+            while (received.load() < total)
+            {
+                bool ok = c == 0 ? numbers.TryPopFront(taken) : numbers.TryPopBack(taken);
+                if (ok)
+                {
+                    seen[taken].fetch_add(1);
+                    received.fetch_add(1);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    for (int i = 0; i < total; ++i)
+        assert(seen[i].load() == 1);
+    assert(numbers.IsEmpty());
+
+    std::cout << "ConcurrentSegmentedDeque tests passed!" << std::endl;
+}
+
+void TestConcurrentLogSequence()
+{
+    std::cout << "Testing ConcurrentLogSequence..." << std::endl;
+    ConcurrentLogSequence<std::string> log;
+
+    assert(log.GetLength() == 0);
+    try
+    {
+        log.GetFirst();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    assert(log.Push("A") == 0);
+    assert(log.Push("B") == 1);
+    assert(log.Emplace(2, 'C') == 2);
+    assert(log.GetLength() == 3);
+    assert(log.GetFirst() == "A");
+    assert(log.GetLast() == "CC");
+    assert(log[1] == "B");
+
+    const std::string *stable = &log[0];
+    for (int i = 0; i < 1000; ++i)
+        log.Push("x");
+    assert(stable == &log[0]);
+
+    auto appended = log.Append("Z");
+    assert(appended->GetLength() == 1004);
+    assert(appended->GetLast() == "Z");
+    assert(log.GetLength() == 1003);
+    auto sub = log.GetSubsequence(1, 2);
+    assert(sub->GetLength() == 2 && sub->Get(1) == "CC");
+
+    // A constructor that throws takes no index, so later items still show.
+    try
+    {
+        log.Emplace(std::string::npos, 'x');
+        assert(false);
+    }
+    catch (const std::length_error &)
+    {
+    }
+    assert(log.Push("after") == 1003);
+    assert(log.GetLength() == 1004 && log.GetLast() == "after");
+
+    const int writers = 4;
+    const int perWriter = 20000;
+    ConcurrentLogSequence<int> numbers;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        int previous = 0;
+        while (!done.load())
+        {
+            int length = numbers.GetLength();
+            assert(length >= previous);
+            if (length > 0)
+                assert(numbers.Get(length - 1) >= 0);
+            previous = length;
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w)
+    {
+        threads.emplace_back([&, w] {
+            for (int i = 0; i < perWriter; ++i)
+                numbers.Push(w * perWriter + i);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    done.store(true);
+    reader.join();
+
+    assert(numbers.GetLength() == writers * perWriter);
+    std::vector<int> seen(writers * perWriter, 0);
+    for (int i = 0; i < numbers.GetLength(); ++i)
+        ++seen[numbers[i]];
+    for (int count : seen)
+        assert(count == 1);
+
+    std::cout << "ConcurrentLogSequence tests passed!" << std::endl;
+}
+
+void TestSnapshotCell()
+{
+    std::cout << "Testing SnapshotCell..." << std::endl;
+    int items[] = {1, 2, 3};
+    SnapshotCell<ISequence<int>> cell(std::make_unique<ArrayImmutableSequence<int>>(items, 3));
+    SnapshotCell<ISequence<int>>::Reader reader(cell);
+
+    assert(reader.Get().GetLength() == 3);
+    auto held = cell.Load();
+    std::uint64_t version = cell.GetVersion();
+
+    cell.Update([](ISequence<int> &current) { return current.Append(4); });
+    assert(cell.GetVersion() == version + 1);
+    assert(held->GetLength() == 3);
+    assert(reader.Get().GetLength() == 4);
+    assert(reader.Get().GetLast() == 4);
+
+    cell.Publish(std::make_unique<ListImmutableSequence<int>>(items, 1));
+    assert(reader.Get().GetLength() == 1);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back([&] {
+            SnapshotCell<ISequence<int>>::Reader local(cell);
+            int previous = 0;
+            while (!done.load())
+            {
+                const ISequence<int> &snapshot = local.Get();
+                int length = snapshot.GetLength();
+                assert(length >= previous);
+                assert(snapshot.GetLast() == length);
+                previous = length;
+            }
+        });
+    }
+    for (int i = 2; i <= 200; ++i)
+    {
+        cell.Update([i](ISequence<int> &current) { return current.Append(i); });
+    }
+    done.store(true);
+    for (auto &thread : readers)
+        thread.join();
+    assert(cell.Load()->GetLength() == 200);
+
+    // A publish that arrives while an update is building its version lands
+    // after that update instead of being overwritten by it.
+    std::atomic<bool> building{false};
+    std::atomic<bool> published{false};
+    std::thread updater([&] {
+        cell.Update([&](ISequence<int> &current)
+                    {
+                        building.store(true);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                        assert(!published.load());
+                        return current.Append(201);
+                    });
+    });
+    while (!building.load())
+        std::this_thread::yield();
+    cell.Publish(std::make_unique<ListImmutableSequence<int>>(items, 2));
+    published.store(true);
+    updater.join();
+    assert(cell.Load()->GetLength() == 2);
+
+    std::cout << "SnapshotCell tests passed!" << std::endl;
+}
+
+void TestMonotonicDeque()
+{
+    std::cout << "Testing MonotonicDeque..." << std::endl;
+    MonotonicDeque<int> minimum;
+    assert(minimum.IsEmpty());
+    try
+    {
+        minimum.Front();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    assert(minimum.Push(5) == 0);
+    assert(minimum.Push(3) == 1);
+    assert(minimum.Push(4) == 2);
+    assert(minimum.GetLength() == 2);
+    assert(minimum.Front() == 3);
+    assert(minimum.FrontPosition() == 1);
+
+    minimum.ExpireBefore(2);
+    assert(minimum.Front() == 4);
+    minimum.Push(4);
+    assert(minimum.GetLength() == 1);
+    assert(minimum.FrontPosition() == 3);
+
+    MonotonicDeque<std::string, std::greater<std::string>> maximum;
+    maximum.Push("b");
+    maximum.Push("a");
+    maximum.Push("c");
+    assert(maximum.Front() == "c");
+    assert(maximum.GetNextPosition() == 3);
+
+    std::cout << "MonotonicDeque tests passed!" << std::endl;
+}
+
+void TestSlidingWindow()
+{
+    std::cout << "Testing SlidingWindow..." << std::endl;
+    try
+    {
+        SlidingWindow<int> invalid(0);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    SlidingWindow<int> window(3);
+    assert(window.IsEmpty());
+    try
+    {
+        window.GetMin();
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    window.Push(4);
+    window.Push(1);
+    assert(window.GetMin() == 1);
+    assert(window.GetMax() == 4);
+    assert(window.GetSum() == 5);
+    window.Push(7);
+    assert(window.IsFull());
+    window.Push(2);
+    assert(window.GetLength() == 3);
+    assert(window.Get(0) == 1);
+    assert(window.GetMin() == 1);
+    assert(window.GetMax() == 7);
+    assert(window.GetSum() == 10);
+    window.Push(5);
+    assert(window.GetMin() == 2);
+    assert(window.GetMean() == 14.0 / 3);
+
+    std::vector<int> stream;
+    unsigned state = 12345;
+    SlidingWindow<int> wide(17);
+    for (int i = 0; i < 1000; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        int value = static_cast<int>((state >> 16) % 1000) - 500;
+        stream.push_back(value);
+        wide.Push(value);
+
+        int first = std::max(0, i - 16);
+        int low = stream[first];
+        int high = stream[first];
+        long long sum = 0;
+        for (int j = first; j <= i; ++j)
+        {
+            low = std::min(low, stream[j]);
+            high = std::max(high, stream[j]);
+            sum += stream[j];
+        }
+        assert(wide.GetMin() == low);
+        assert(wide.GetMax() == high);
+        assert(wide.GetSum() == sum);
+    }
+
+    SlidingWindow<double> fractions(4);
+    for (int i = 0; i < 100; ++i)
+    {
+        fractions.Push(0.1 * i);
+    }
+    assert(std::abs(fractions.GetMean() - 0.1 * 97.5) < 1e-9);
+
+    window.Clear();
+    assert(window.IsEmpty());
+    window.Push(-1);
+    assert(window.GetMax() == -1);
+
+    std::cout << "SlidingWindow tests passed!" << std::endl;
+}
+
+void TestTimerWheel()
+{
+    std::cout << "Testing TimerWheel..." << std::endl;
+    TimerWheel<std::string> wheel;
+    assert(wheel.IsEmpty());
+
+    auto first = wheel.Schedule(5, "first");
+    auto second = wheel.Schedule(3, "second");
+    auto cancelled = wheel.Schedule(4, "cancelled");
+    auto moved = wheel.Schedule(1, "moved");
+    assert(wheel.GetLength() == 4);
+    assert(wheel.Get(first) == "first");
+    assert(wheel.GetExpiry(second) == 3);
+
+    assert(wheel.Cancel(cancelled));
+    assert(!wheel.Cancel(cancelled));
+    assert(!wheel.Contains(cancelled));
+    wheel.Reschedule(moved, 10);
+
+    std::vector<std::string> fired;
+    auto collect = [&](std::string &&item) { fired.push_back(std::move(item)); };
+    assert(wheel.Advance(2, collect) == 0);
+    assert(wheel.Advance(3, collect) == 2);
+    assert(fired.size() == 2 && fired[0] == "second" && fired[1] == "first");
+    assert(!wheel.Contains(first));
+    try
+    {
+        wheel.Get(first);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    auto reused = wheel.Schedule(0, "next tick");
+    assert(reused.slot == first.slot);
+    assert(!wheel.Contains(first));
+    assert(wheel.Advance(1, collect) == 1);
+    assert(fired.back() == "next tick");
+    assert(wheel.Advance(4, collect) == 1);
+    assert(fired.back() == "moved");
+    assert(wheel.GetCurrentTick() == 10);
+
+    TimerWheel<int> numbers;
+    std::vector<std::pair<unsigned long long, int>> expected;
+    std::vector<TimerWheel<int>::Handle> handles;
+    unsigned long long state = 99;
+    for (int i = 0; i < 5000; ++i)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned long long delay = (state >> 33) % (i % 10 == 0 ? 20000000 : 70000);
+        handles.push_back(numbers.Schedule(delay, i));
+        expected.push_back({delay == 0 ? 1 : delay, i});
+    }
+    for (int i = 0; i < 5000; i += 7)
+    {
+        assert(numbers.Cancel(handles[i]));
+        expected[i].first = 0;
+    }
+    std::vector<std::pair<unsigned long long, int>> due;
+    for (const auto &entry : expected)
+    {
+        if (entry.first != 0)
+            due.push_back(entry);
+    }
+    std::sort(due.begin(), due.end());
+
+    std::vector<std::pair<unsigned long long, int>> order;
+    numbers.Advance(25000000, [&](int item) { order.push_back({numbers.GetCurrentTick(), item}); });
+    std::sort(order.begin(), order.end());
+    assert(order == due);
+    assert(numbers.IsEmpty());
+
+    int chained = 0;
+    numbers.Schedule(300, 0);
+    numbers.Advance(100000, [&](int depth) {
+        ++chained;
+        if (depth < 50)
+            numbers.Schedule(300 + depth, depth + 1);
+    });
+    assert(chained == 51);
+
+    unsigned long long start = numbers.GetCurrentTick();
+    numbers.Schedule(1ULL << 40, 1);
+    unsigned long long firedAt = 0;
+    assert(numbers.Advance(1ULL << 41, [&](int) { firedAt = numbers.GetCurrentTick(); }) == 1);
+    assert(firedAt == start + (1ULL << 40));
+
+    numbers.Schedule(1ULL << 40, 1);
+    numbers.Schedule(1, 2);
+    numbers.Clear();
+    assert(numbers.IsEmpty());
+
+    std::cout << "TimerWheel tests passed!" << std::endl;
+}
+
+void TestRangeQuerySequence()
+{
+    std::cout << "Testing RangeQuerySequence..." << std::endl;
+    int items[] = {5, 3, 8, 1, 9, 2};
+    RangeQuerySequence<int> sums(items, 6);
+    assert(sums.GetLength() == 6);
+    assert(sums.Reduce() == 28);
+    assert(sums.RangeReduce(1, 3) == 12);
+    assert(sums.RangeReduce(4, 4) == 9);
+    try
+    {
+        sums.RangeReduce(3, 6);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    sums.Set(2, -2);
+    assert(sums.Get(2) == -2);
+    assert(sums.RangeReduce(0, 5) == 18);
+    sums.AppendInPlace(10);
+    sums.PrependInPlace(100);
+    sums.InsertAtInPlace(7, 3);
+    sums.RemoveAtInPlace(1);
+    assert(sums.GetFirst() == 100);
+    assert(sums.GetLast() == 10);
+    assert(sums.RangeReduce(1, 2) == 10);
+    assert(sums.Reduce() == 130);
+
+    auto sub = sums.GetSubsequence(1, 3);
+    assert(sub->GetLength() == 3);
+    assert(static_cast<RangeQuerySequence<int> *>(sub.get())->Reduce() == 8);
+
+    MutableSequence<int> *base = &sums;
+    base->ConcatInPlace(sub.get());
+    assert(sums.GetLength() == 11);
+    assert(sums.RangeReduce(8, 10) == 8);
+
+    RangeQuerySequence<int, RangeMin<int>> minimums(items, 6);
+    RangeQuerySequence<int, RangeMax<int>> maximums;
+    std::vector<int> reference(items, items + 6);
+    for (int item : reference)
+    {
+        maximums.AppendInPlace(item);
+    }
+    unsigned state = 77;
+    for (int step = 0; step < 2000; ++step)
+    {
+        state = state * 1103515245u + 12345u;
+        int value = static_cast<int>((state >> 16) % 1000);
+        int position = static_cast<int>((state >> 8) % reference.size());
+        if (step % 3 == 0)
+        {
+            reference.push_back(value);
+            minimums.AppendInPlace(value);
+            maximums.AppendInPlace(value);
+        }
+        else
+        {
+            reference[position] = value;
+            minimums.Set(position, value);
+            maximums.Set(position, value);
+        }
+
+        int first = static_cast<int>((state >> 4) % reference.size());
+        int last = first + static_cast<int>((state >> 12) % (reference.size() - first));
+        int low = reference[first];
+        int high = reference[first];
+        for (int i = first; i <= last; ++i)
+        {
+            low = std::min(low, reference[i]);
+            high = std::max(high, reference[i]);
+        }
+        assert(minimums.RangeReduce(first, last) == low);
+        assert(maximums.RangeReduce(first, last) == high);
+    }
+    assert(minimums.Reduce() == *std::min_element(reference.begin(), reference.end()));
+
+    std::string words[] = {"a", "b", "c", "d"};
+    struct Concat
+    {
+        std::string operator()(const std::string &a, const std::string &b) const { return a + b; }
+        static std::string Identity() { return ""; }
+    };
+    RangeQuerySequence<std::string, Concat> text(words, 4);
+    assert(text.RangeReduce(1, 3) == "bcd");
+    text.Set(2, "x");
+    assert(text.Reduce() == "abxd");
+
+    std::cout << "RangeQuerySequence tests passed!" << std::endl;
+}
+
+void TestFraming()
+{
+    std::cout << "Testing Framing..." << std::endl;
+    char header[MAX_VARINT_BYTES];
+    assert(EncodeVarint(0, header) == 1 && header[0] == 0);
+    assert(EncodeVarint(300, header) == 2);
+    assert(static_cast<unsigned char>(header[0]) == 0xAC && header[1] == 0x02);
+
+    ReceiveRing ring(16);
+    assert(ring.GetCapacity() == 1024);
+    std::string scratch;
+    ring.Append(std::string(1000, 'a'));
+    ring.Consume(990);
+    ring.Append("0123456789abcdefghijklmnopqrstuvwxyz");
+    std::string_view wrapped = ring.View(30, 10, scratch);
+    assert(wrapped == "klmnopqrst");
+    assert(wrapped.data() == scratch.data());
+    assert(ring.View(10, 10, scratch) == "0123456789");
+    assert(ring.Find('z', 10) == 45);
+    assert(ring.Find('!', 0) == std::string_view::npos);
+
+    std::string stream;
+    AppendFrame(stream, "first");
+    AppendFrame(stream, "");
+    AppendFrame(stream, std::string(3000, 'x'));
+    AppendFrame(stream, "last");
+    int pipeFds[2];
+    assert(pipe(pipeFds) == 0);
+    ReceiveRing input(1024);
+    FrameDecoder decoder;
+    std::vector<std::string> frames;
+    auto collect = [&](std::string_view frame) { frames.emplace_back(frame); };
+    size_t written = 0;
+    size_t readTotal = 0;
+    while (written < stream.size())
+    {
+        size_t chunk = std::min<size_t>(700, stream.size() - written);
+        assert(write(pipeFds[1], stream.data() + written, chunk) == static_cast<ssize_t>(chunk));
+        written += chunk;
+        while (readTotal < written)
+        {
+            ssize_t count = input.FillFrom(pipeFds[0]);
+            assert(count > 0);
+            readTotal += count;
+            assert(decoder.Drain(input, collect) == FrameDecoder::Status::NeedMore);
+        }
+    }
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+    assert(frames.size() == 4);
+    assert(frames[0] == "first" && frames[1].empty());
+    assert(frames[2] == std::string(3000, 'x') && frames[3] == "last");
+    assert(input.GetCapacity() >= 3002);
+
+    FrameDecoder lines(FramingMode::NewlineDelimited, 8);
+    ReceiveRing text(1024);
+    frames.clear();
+    text.Append("one\ntw");
+    assert(lines.Drain(text, collect) == FrameDecoder::Status::NeedMore);
+    text.Append("o\n\nthree");
+    assert(lines.Drain(text, collect) == FrameDecoder::Status::NeedMore);
+    assert(frames.size() == 3 && frames[0] == "one" && frames[1] == "two" && frames[2].empty());
+    text.Append("teen ninety");
+    assert(lines.Drain(text, collect) == FrameDecoder::Status::TooLarge);
+
+    FrameDecoder bounded(FramingMode::LengthPrefixed, 100);
+    ReceiveRing big(1024);
+    std::string tooLong;
+    AppendFrame(tooLong, std::string(101, 'y'));
+    big.Append(tooLong);
+    assert(bounded.Drain(big, collect) == FrameDecoder::Status::TooLarge);
+
+    std::cout << "Framing tests passed!" << std::endl;
+}
+
+int ConnectLoopback(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    int result = connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    assert(result == 0);
+    return fd;
+}
+
+template <typename Condition>
+bool WaitFor(Condition condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void CheckStreamServer(ReceiveBackend backend)
+{
+    std::mutex receivedMutex;
+    std::map<int, std::vector<std::string>> received;
+    StreamServer::Options options;
+    options.port = 0;
+    options.loops = 2;
+    options.receiveBuffer = 1024;
+    options.backend = backend;
+    options.uringBuffers = 8;
+    StreamServer server(
+        [&](int connection, std::string_view message) {
+            std::lock_guard<std::mutex> lock(receivedMutex);
+            received[connection].emplace_back(message);
+        },
+        options);
+    server.Start();
+    assert(server.GetPort() > 0);
+
+    const int clientCount = 64;
+    std::vector<int> clients;
+    for (int i = 0; i < clientCount; ++i)
+    {
+        clients.push_back(ConnectLoopback(server.GetPort()));
+    }
+    long long sent = 0;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < clientCount; ++i)
+        {
+            std::string frames;
+            AppendFrame(frames, "client" + std::to_string(i));
+            if (i == 0)
+                AppendFrame(frames, std::string(5000, 'z'));
+            if (round == 0 && i % 4 == 0)
+            {
+                for (char byte : frames)
+                {
+                    assert(send(clients[i], &byte, 1, 0) == 1);
+                }
+            }
+            else
+            {
+                assert(send(clients[i], frames.data(), frames.size(), 0) == static_cast<ssize_t>(frames.size()));
+            }
+            sent += frames.size();
+        }
+    }
+    assert(WaitFor([&] { return server.GetStats().bytes == sent; }));
+    StreamServer::Stats stats = server.GetStats();
+    assert(stats.accepted == clientCount);
+    assert(stats.messages == 3 * (clientCount + 1));
+    {
+        std::lock_guard<std::mutex> lock(receivedMutex);
+        assert(static_cast<int>(received.size()) == clientCount);
+        for (const auto &entry : received)
+        {
+            const std::vector<std::string> &frames = entry.second;
+            assert(frames[0].compare(0, 6, "client") == 0);
+            if (frames[0] == "client0")
+            {
+                assert(frames.size() == 6);
+                assert(frames[1] == std::string(5000, 'z'));
+            }
+            else
+            {
+                assert(frames.size() == 3 && frames[1] == frames[0] && frames[2] == frames[0]);
+            }
+        }
+    }
+
+    int bad = ConnectLoopback(server.GetPort());
+    std::string oversized(MAX_VARINT_BYTES, static_cast<char>(0xFF));
+    assert(send(bad, oversized.data(), oversized.size(), 0) == static_cast<ssize_t>(oversized.size()));
+    assert(WaitFor([&] { return server.GetStats().malformed == 1; }));
+    close(bad);
+
+    for (int fd : clients)
+    {
+        close(fd);
+    }
+    assert(WaitFor([&] { return server.GetStats().closed == clientCount + 1; }));
+    server.Stop();
+    stats = server.GetStats();
+    assert(stats.bytes == sent + MAX_VARINT_BYTES);
+    assert(stats.waits > 0 && stats.reads > 0);
+    assert(backend == ReceiveBackend::IoUring ? stats.receiveCalls == 0 : stats.receiveCalls >= stats.reads);
+}
+
+// Runs the process out of descriptors while a client connects: the failed
+// accept is counted, the loop does not spin retrying it, and the client is
+// accepted once another connection closes, onto the descriptor that
+// connection had. io_uring reads the limit when the accept is submitted, so
+// it is lowered before the server starts.
+void CheckAcceptFailures(ReceiveBackend backend)
+{
+    rlimit original;
+    assert(getrlimit(RLIMIT_NOFILE, &original) == 0);
+    int lowest = dup(0);
+    close(lowest);
+    rlimit lowered = original;
+    lowered.rlim_cur = static_cast<rlim_t>(lowest + 16);
+    assert(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+
+    StreamServer::Options options;
+    options.port = 0;
+    options.backend = backend;
+    StreamServer server(nullptr, options);
+    server.Start();
+    int first = ConnectLoopback(server.GetPort());
+    assert(WaitFor([&] { return server.GetStats().accepted == 1; }));
+
+    std::vector<int> fillers;
+    for (int fd; (fd = dup(0)) >= 0;)
+    {
+        fillers.push_back(fd);
+    }
+    close(fillers.back());
+    fillers.pop_back();
+    int second = ConnectLoopback(server.GetPort());
+    assert(WaitFor([&] { return server.GetStats().acceptFailures >= 1; }));
+    long long waits = server.GetStats().waits;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(server.GetStats().waits - waits < 10 && server.GetStats().accepted == 1);
+
+    // Keeps the client's descriptor, so the only one freed is the server's.
+    shutdown(first, SHUT_WR);
+    assert(WaitFor([&] { return server.GetStats().accepted == 2; }));
+    std::string frame;
+    AppendFrame(frame, "after");
+    assert(send(second, frame.data(), frame.size(), 0) == static_cast<ssize_t>(frame.size()));
+    assert(WaitFor([&] { return server.GetStats().messages == 1; }));
+    close(second);
+    assert(WaitFor([&] { return server.GetStats().closed == 2; }));
+    close(first);
+    for (int fd : fillers)
+    {
+        close(fd);
+    }
+    assert(setrlimit(RLIMIT_NOFILE, &original) == 0);
+    server.Stop();
+}
+
+void TestStreamServer()
+{
+    std::cout << "Testing StreamServer..." << std::endl;
+    try
+    {
+        StreamServer::Options invalid;
+        invalid.loops = 0;
+        StreamServer server(nullptr, invalid);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    try
+    {
+        StreamServer::Options invalid;
+        invalid.uringBuffers = 100;
+        StreamServer server(nullptr, invalid);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    CheckStreamServer(ReceiveBackend::Epoll);
+    StreamServer::Options uring;
+    uring.backend = ReceiveBackend::IoUring;
+    StreamServer probe(nullptr, uring);
+    assert(probe.GetBackend() == (IoUring::IsSupported() ? ReceiveBackend::IoUring : ReceiveBackend::Epoll));
+    CheckStreamServer(probe.GetBackend());
+    CheckAcceptFailures(ReceiveBackend::Epoll);
+    CheckAcceptFailures(probe.GetBackend());
+
+    if (IoUring::IsSupported())
+    {
+        // Preparing past a full submission queue submits it first; every
+        // (zeroed, so no-op) request completes once.
+        IoUring ring(4);
+        for (int i = 0; i < 8; ++i)
+        {
+            ring.Prepare()->user_data = static_cast<uint64_t>(i);
+        }
+        assert(ring.Submit(0));
+        std::vector<bool> completed(8, false);
+        unsigned reaped = 0;
+        while (reaped < 8)
+        {
+            reaped += ring.Reap([&](const io_uring_cqe &completion)
+                                {
+                                    assert(completion.res == 0 && !completed[completion.user_data]);
+                                    completed[completion.user_data] = true;
+                                });
+        }
+    }
+
+    std::cout << "StreamServer tests passed!" << std::endl;
+}
+
+struct Delivery
+{
+    std::string topic;
+    long long offset;
+    std::string body;
+};
+
+// Reads Deliver frames from a blocking socket until `count` have arrived or
+// a read times out.
+std::vector<Delivery> ReadDeliveries(int fd, size_t count)
+{
+    timeval timeout{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ReceiveRing ring(1024);
+    FrameDecoder decoder;
+    std::vector<Delivery> deliveries;
+    while (deliveries.size() < count)
+    {
+        ssize_t received = ring.FillFrom(fd);
+        if (received <= 0)
+            break;
+        FrameDecoder::Status status = decoder.Drain(ring, [&](std::string_view payload)
+                                                    {
+                                                        TopicFrame frame;
+                                                        assert(ParseTopicFrame(payload, frame));
+                                                        assert(frame.kind == FrameKind::Deliver);
+                                                        deliveries.push_back({std::string(frame.topic), frame.offset, std::string(frame.body)});
+                                                    });
+        assert(status == FrameDecoder::Status::NeedMore);
+    }
+    return deliveries;
+}
+
+void SendFrames(int fd, const std::string &frames)
+{
+    size_t sent = 0;
+    while (sent < frames.size())
+    {
+        ssize_t count = send(fd, frames.data() + sent, frames.size() - sent, 0);
+        assert(count > 0);
+        sent += count;
+    }
+}
+
+// Subscribers that reset their connections while deliveries are being
+// written to them; the writes fail instead of raising SIGPIPE, which this
+// process does not ignore.
+void CheckResetSubscribers()
+{
+    Broker::Options options;
+    options.server.port = 0;
+    Broker broker(options);
+    broker.Start();
+    std::string body(4096, 'r');
+    for (int i = 0; i < 200; ++i)
+    {
+        broker.Publish("reset", body);
+    }
+
+    const int count = 32;
+    std::vector<int> subscribers;
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "reset", "", 0);
+    for (int i = 0; i < count; ++i)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int small = 4096;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(broker.GetPort()));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        assert(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+        SendFrames(fd, subscribe);
+        subscribers.push_back(fd);
+    }
+    assert(WaitFor([&] { return broker.GetStats().subscribed == count; }));
+
+    std::atomic<bool> done{false};
+    std::thread publisher([&]
+                          {
+                              while (!done.load())
+                              {
+                                  broker.Publish("reset", body);
+                              }
+                          });
+    linger reset{1, 0};
+    for (int fd : subscribers)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    assert(WaitFor([&] { return broker.GetServerStats().closed == count; }));
+    done.store(true);
+    publisher.join();
+    broker.Stop();
+}
+
+void TestBroker()
+{
+    std::cout << "Testing Broker..." << std::endl;
+    std::string frame;
+    AppendTopicFrame(frame, FrameKind::Deliver, "topic", "body", 41);
+    TopicFrame parsed;
+    uint64_t length = 0;
+    int prefix = DecodeVarint(frame, length);
+    assert(prefix == 1 && length == frame.size() - 1);
+    assert(ParseTopicFrame(std::string_view(frame).substr(prefix), parsed));
+    assert(parsed.kind == FrameKind::Deliver && parsed.topic == "topic");
+    assert(parsed.offset == 41 && parsed.body == "body");
+    assert(!ParseTopicFrame("", parsed) && !ParseTopicFrame("x", parsed));
+
+    Broker::Options options;
+    options.server.port = 0;
+    options.deliveryBatch = 64;
+    Broker broker(options);
+    RetentionPolicy lastFive;
+    lastFive.maxCount = 5;
+    broker.CreateTopic("bounded", lastFive);
+    broker.Start();
+
+    int early = ConnectLoopback(broker.GetPort());
+    int late = ConnectLoopback(broker.GetPort());
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "alpha", "", 0);
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "beta", "", 0);
+    SendFrames(early, subscribe);
+    subscribe.clear();
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "alpha");
+    SendFrames(late, subscribe);
+    assert(WaitFor([&] { return broker.GetStats().subscribed == 3; }));
+
+    int publisher = ConnectLoopback(broker.GetPort());
+    std::string frames;
+    const int count = 2000;
+    for (int i = 0; i < count; ++i)
+    {
+        AppendTopicFrame(frames, FrameKind::Publish, "alpha", "a" + std::to_string(i));
+        if (i % 100 == 0)
+            AppendTopicFrame(frames, FrameKind::Publish, "beta", "b" + std::to_string(i));
+    }
+    std::string large(300000, 'L');
+    AppendTopicFrame(frames, FrameKind::Publish, "alpha", large);
+    AppendTopicFrame(frames, FrameKind::Publish, "bad/topic", "x");
+    AppendTopicFrame(frames, FrameKind::Deliver, "alpha", "x", 3);
+    SendFrames(publisher, frames);
+
+    std::vector<Delivery> first = ReadDeliveries(early, count + 1 + count / 100);
+    std::vector<Delivery> second = ReadDeliveries(late, count + 1);
+    assert(first.size() == count + 1 + count / 100 && second.size() == count + 1);
+    long long alpha = 0;
+    long long beta = 0;
+    for (const Delivery &delivery : first)
+    {
+        if (delivery.topic == "beta")
+        {
+            assert(delivery.offset == beta && delivery.body == "b" + std::to_string(beta * 100));
+            ++beta;
+            continue;
+        }
+        assert(delivery.topic == "alpha" && delivery.offset == alpha);
+        assert(alpha == count ? delivery.body == large : delivery.body == "a" + std::to_string(alpha));
+        ++alpha;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        assert(second[i].offset == i && second[i].body == "a" + std::to_string(i));
+    }
+    assert(second[count].body == large);
+    assert(WaitFor([&] { return broker.GetStats().rejected == 2; }));
+
+    for (int i = 0; i < 20; ++i)
+    {
+        assert(broker.Publish("bounded", "c" + std::to_string(i)) == i);
+    }
+    int reader = ConnectLoopback(broker.GetPort());
+    subscribe.clear();
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "bounded", "", 0);
+    SendFrames(reader, subscribe);
+    std::vector<Delivery> bounded = ReadDeliveries(reader, 5);
+    assert(bounded.size() == 5 && bounded[0].offset == 15 && bounded[4].body == "c19");
+
+    close(late);
+    assert(WaitFor([&] { return broker.GetServerStats().closed == 1; }));
+    broker.Publish("alpha", "after");
+    assert(ReadDeliveries(early, 1)[0].body == "after");
+    std::map<std::string, long long> next;
+    broker.ForEachTopic([&](const std::string &name, const Broker::Stream &stream)
+                        { next[name] = stream.GetNextOffset(); });
+    assert(next.size() == 3 && next["alpha"] == count + 2 && next["bounded"] == 20);
+
+    // The counters move after the bytes are written, so they may trail
+    // what the readers have already seen.
+    assert(WaitFor([&] { return broker.GetStats().delivered == 2 * (count + 1) + count / 100 + 5 + 1; }));
+    Broker::Stats stats = broker.GetStats();
+    assert(stats.published == count + 1 + count / 100 + 21);
+    assert(stats.writes < stats.delivered / 4 && stats.dropped == 0);
+    close(early);
+    close(publisher);
+    close(reader);
+    broker.Stop();
+    CheckResetSubscribers();
+
+    std::cout << "Broker tests passed!" << std::endl;
+}
+
+void CheckBrokerBackpressure(ReceiveBackend backend)
+{
+    Broker::Options options;
+    options.server.port = 0;
+    options.server.backend = backend;
+    options.highWatermark = 1000;
+    options.lowWatermark = 100;
+    Broker broker(options);
+    broker.Start();
+
+    // A subscriber with a small receive buffer that does not read yet.
+    int subscriber = socket(AF_INET, SOCK_STREAM, 0);
+    int small = 4096;
+    setsockopt(subscriber, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(broker.GetPort()));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    assert(connect(subscriber, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "flow", "", 0);
+    SendFrames(subscriber, subscribe);
+    assert(WaitFor([&] { return broker.GetStats().subscribed == 1; }));
+
+    const int count = 20000;
+    std::string body(1024, 'f');
+    int publisher = ConnectLoopback(broker.GetPort());
+    std::thread sender([&]
+                       {
+                           std::string frames;
+                           for (int i = 0; i < count; ++i)
+                           {
+                               body[0] = static_cast<char>('a' + i % 26);
+                               AppendTopicFrame(frames, FrameKind::Publish, "flow", body);
+                           }
+                           SendFrames(publisher, frames);
+                       });
+
+    // Paused, the publisher stays stuck near the high watermark plus what
+    // the subscriber's socket buffers hold.
+    assert(WaitFor([&] { return broker.GetServerStats().pauses >= 1; }));
+    assert(broker.GetStats().throttled >= 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(broker.GetStats().published < count);
+
+    std::vector<Delivery> deliveries = ReadDeliveries(subscriber, count);
+    sender.join();
+    assert(deliveries.size() == count);
+    for (int i = 0; i < count; ++i)
+    {
+        assert(deliveries[i].offset == i && deliveries[i].body[0] == 'a' + i % 26);
+    }
+    StreamServer::Stats stats = broker.GetServerStats();
+    assert(stats.resumes >= 1 && stats.resumes <= stats.pauses);
+    assert(stats.pausedMicroseconds > 0);
+    assert(broker.GetStats().published == count && broker.GetStats().dropped == 0);
+
+    // Without subscribers there is no backlog to hold publishers back.
+    close(subscriber);
+    assert(WaitFor([&] { return broker.GetServerStats().closed == 1; }));
+    std::string frames;
+    for (int i = 0; i < 3000; ++i)
+    {
+        AppendTopicFrame(frames, FrameKind::Publish, "flow", "x");
+    }
+    SendFrames(publisher, frames);
+    assert(WaitFor([&] { return broker.GetStats().published == count + 3000; }));
+    close(publisher);
+    broker.Stop();
+}
+
+// A paused publisher that resets its connection must not leave its
+// descriptor in the topic's pause set: draining that topic would then
+// resume whichever connection took the number next.
+void CheckStalePause()
+{
+    Broker::Options options;
+    options.server.port = 0;
+    // Only a subscriber that reads can bring a backlog down to one, and a
+    // stalled socket cannot take in the thousands above that.
+    options.highWatermark = 2000;
+    options.lowWatermark = 1;
+    Broker broker(options);
+    broker.Start();
+
+    auto subscribe = [&](const char *topic)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int small = 4096;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(broker.GetPort()));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        assert(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+        std::string frame;
+        AppendTopicFrame(frame, FrameKind::Subscribe, topic, "", 0);
+        SendFrames(fd, frame);
+        return fd;
+    };
+    int first = subscribe("first");
+    int second = subscribe("second");
+    assert(WaitFor([&] { return broker.GetStats().subscribed == 2; }));
+
+    // Publishes to `topic` until the broker has stopped reading for good:
+    // the subscriber's socket is full and the publisher is paused.
+    std::string body(1024, 's');
+    auto publishUntilPaused = [&](const char *topic)
+    {
+        std::string frames;
+        for (int i = 0; i < 20000; ++i)
+        {
+            AppendTopicFrame(frames, FrameKind::Publish, topic, body);
+        }
+        int fd = ConnectLoopback(broker.GetPort());
+        size_t sent = 0;
+        auto progress = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - progress < std::chrono::milliseconds(300))
+        {
+            ssize_t written = send(fd, frames.data() + sent, frames.size() - sent, MSG_DONTWAIT);
+            if (written > 0)
+            {
+                sent += static_cast<size_t>(written);
+                progress = std::chrono::steady_clock::now();
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            assert(sent < frames.size());
+        }
+        return fd;
+    };
+
+    int doomed = publishUntilPaused("first");
+    linger reset{1, 0};
+    setsockopt(doomed, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    close(doomed);
+    assert(WaitFor([&] { return broker.GetServerStats().closed == 1; }));
+    StreamServer::Stats stats = broker.GetServerStats();
+    assert(stats.pauses == stats.resumes + 1);
+
+    // The next connection gets the lowest free descriptor, the one just
+    // closed, and is paused on the other topic.
+    int publisher = publishUntilPaused("second");
+    stats = broker.GetServerStats();
+    assert(stats.pauses == stats.resumes + 2);
+    long long published = broker.GetStats().published;
+
+    long long backlog = 0;
+    broker.ForEachTopic([&](const std::string &name, const Broker::Stream &stream)
+                        {
+                            if (name == "first")
+                                backlog = stream.GetNextOffset();
+                        });
+    assert(static_cast<long long>(ReadDeliveries(first, backlog).size()) == backlog);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(broker.GetServerStats().resumes == stats.resumes && broker.GetStats().published == published);
+
+    // Draining its own topic does resume it.
+    broker.ForEachTopic([&](const std::string &name, const Broker::Stream &stream)
+                        {
+                            if (name == "second")
+                                backlog = stream.GetNextOffset();
+                        });
+    assert(static_cast<long long>(ReadDeliveries(second, backlog).size()) == backlog);
+    assert(WaitFor([&] { return broker.GetServerStats().resumes > stats.resumes; }));
+    close(first);
+    close(second);
+    close(publisher);
+    broker.Stop();
+}
+
+void TestBrokerBackpressure()
+{
+    std::cout << "Testing Broker backpressure..." << std::endl;
+    CheckBrokerBackpressure(ReceiveBackend::Epoll);
+    if (IoUring::IsSupported())
+        CheckBrokerBackpressure(ReceiveBackend::IoUring);
+    CheckStalePause();
+
+    try
+    {
+        Broker::Options inverted;
+        inverted.highWatermark = 10;
+        inverted.lowWatermark = 10;
+        Broker invalid(inverted);
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    std::cout << "Broker backpressure tests passed!" << std::endl;
+}
+
+void TestBrokerAcks()
+{
+    std::cout << "Testing Broker acks..." << std::endl;
+    std::string ack;
+    AppendTopicFrame(ack, FrameKind::Ack, "t", "x", 2);
+    TopicFrame parsed;
+    assert(ParseTopicFrame(std::string_view(ack).substr(1), parsed) && parsed.kind == FrameKind::Ack);
+
+    Broker::Options options;
+    options.server.port = 0;
+    Broker broker(options);
+    broker.Start();
+
+    // One connection that subscribes and publishes with acks gets both
+    // kinds of frame, each intact and in order.
+    int client = ConnectLoopback(broker.GetPort());
+    std::string frames;
+    AppendTopicFrame(frames, FrameKind::Subscribe, "acked", "", 0);
+    SendFrames(client, frames);
+    assert(WaitFor([&] { return broker.GetStats().subscribed == 1; }));
+    frames.clear();
+    const int count = 3000;
+    std::string large(100000, 'A');
+    for (int i = 0; i < count; ++i)
+    {
+        AppendTopicFrame(frames, FrameKind::Publish, "acked", i % 1000 == 0 ? large : "m" + std::to_string(i),
+                         1000000 + i);
+    }
+    AppendTopicFrame(frames, FrameKind::Publish, "bad/topic", "x", 7);
+    AppendTopicFrame(frames, FrameKind::Publish, "acked", "untagged");
+    AppendTopicFrame(frames, FrameKind::Ack, "acked", "", 0);
+    SendFrames(client, frames);
+
+    timeval timeout{5, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ReceiveRing ring(1024);
+    FrameDecoder decoder;
+    std::vector<uint64_t> tags;
+    std::vector<long long> ackOffsets;
+    std::vector<long long> delivered;
+    while (tags.size() < count + 1 || delivered.size() < count + 1)
+    {
+        ssize_t received = ring.FillFrom(client);
+        if (received <= 0)
+            break;
+        decoder.Drain(ring, [&](std::string_view payload)
+                      {
+                          TopicFrame frame;
+                          assert(ParseTopicFrame(payload, frame));
+                          if (frame.kind == FrameKind::Deliver)
+                          {
+                              long long offset = frame.offset;
+                              assert(offset == static_cast<long long>(delivered.size()));
+                              assert(offset == count ? frame.body == "untagged"
+                                                     : offset % 1000 == 0 ? frame.body == large
+                                                                          : frame.body == "m" + std::to_string(offset));
+                              delivered.push_back(offset);
+                              return;
+                          }
+                          assert(frame.kind == FrameKind::Ack);
+                          uint64_t tag = 0;
+                          assert(DecodeVarint(frame.body, tag) == static_cast<int>(frame.body.size()));
+                          tags.push_back(tag);
+                          ackOffsets.push_back(frame.offset);
+                      });
+    }
+    assert(tags.size() == count + 1 && delivered.size() == count + 1);
+    for (int i = 0; i < count; ++i)
+    {
+        assert(tags[i] == static_cast<uint64_t>(1000000 + i) && ackOffsets[i] == i);
+    }
+    assert(tags[count] == 7 && ackOffsets[count] == -1);
+
+    // The trailing Ack frame is rejected after the last delivery is sent.
+    assert(WaitFor([&]
+                   {
+                       Broker::Stats stats = broker.GetStats();
+                       return stats.acknowledged == count + 1 && stats.rejected == 2;
+                   }));
+    close(client);
+    assert(WaitFor([&] { return broker.GetServerStats().closed == 1; }));
+    broker.Stop();
+
+    std::cout << "Broker acks tests passed!" << std::endl;
+}
+
+void TestBufferedStream()
+{
+    std::cout << "Testing BufferedStream..." << std::endl;
+    BufferedStream<std::string> unbounded;
+    unbounded.SetCurrent("a");
+    assert(unbounded.GetCurrent().value() == "a");
+    unbounded.CommitCurrentToBuffer();
+    assert(!unbounded.GetCurrent().has_value());
+    assert(unbounded.Add("b") == 1);
+    assert(unbounded.GetLength() == 2 && unbounded.GetLast() == "b");
+
+    RetentionPolicy byCount;
+    byCount.maxCount = 3;
+    BufferedStream<std::string> stream(byCount);
+    for (int i = 0; i < 10; ++i)
+    {
+        assert(stream.Add("m" + std::to_string(i)) == i);
+    }
+    assert(stream.GetLength() == 3);
+    assert(stream.GetFirstOffset() == 7);
+    assert(stream.GetNextOffset() == 10);
+    assert(stream.GetAtOffset(8) == "m8");
+    assert(stream.GetFirst() == "m7");
+    try
+    {
+        stream.GetAtOffset(6);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+    try
+    {
+        stream.GetAtOffset(10);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    stream.RemoveAtInPlace(0);
+    assert(stream.GetFirstOffset() == 8);
+    stream.InsertAtInPlace("inserted", 1);
+    assert(stream.Get(1) == "inserted" && stream.GetLast() == "m9");
+    assert(stream.GetNextOffset() == 11);
+
+    RetentionPolicy byBytes;
+    byBytes.maxBytes = 10;
+    stream.SetRetention(byBytes);
+    assert(stream.GetRetainedBytes() <= 10);
+    stream.Add(std::string(25, 'x'));
+    assert(stream.GetLength() == 1);
+    assert(stream.GetRetainedBytes() == 25);
+    stream.Add("abcd");
+    assert(stream.GetLength() == 1 && stream.GetRetainedBytes() == 4);
+    stream.Add("efgh");
+    assert(stream.GetLength() == 2 && stream.GetRetainedBytes() == 8);
+
+    RetentionPolicy byAge;
+    byAge.maxAge = std::chrono::milliseconds(20);
+    BufferedStream<int> recent(byAge);
+    recent.Add(1);
+    recent.Add(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    recent.Add(3);
+    assert(recent.GetLength() == 1 && recent.GetFirstOffset() == 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    recent.EvictExpired();
+    assert(recent.GetLength() == 0 && recent.GetNextOffset() == 3);
+
+    MutableSequence<int> *base = &recent;
+    base->AppendInPlace(4);
+    auto copy = recent.Append(5);
+    assert(copy->GetLength() == 2 && copy->GetLast() == 5);
+
+    std::cout << "BufferedStream tests passed!" << std::endl;
+}
+
+void TestStreamConsumers()
+{
+    std::cout << "Testing StreamConsumers..." << std::endl;
+    RetentionPolicy byCount;
+    byCount.maxCount = 5;
+    BufferedStream<std::string> stream(byCount);
+    auto early = stream.Subscribe("early");
+    assert(early.Poll(10).IsEmpty());
+    for (int i = 0; i < 4; ++i)
+    {
+        stream.Add("m" + std::to_string(i));
+    }
+    {
+        auto batch = early.Poll(3);
+        assert(batch.GetLength() == 3 && batch.GetFirstOffset() == 0);
+        assert(batch[0] == "m0" && batch[2] == "m2");
+        assert(&batch[1] == &stream.GetAtOffset(1));
+    }
+    assert(early.GetPosition() == 3 && early.GetCommittedOffset() == -1);
+    early.Commit();
+    assert(stream.GetCommittedOffset("early") == 3);
+    early.Commit(1);
+    assert(early.GetCommittedOffset() == 3);
+
+    auto resumed = stream.Subscribe("early");
+    assert(resumed.GetPosition() == 3);
+    auto fresh = stream.Subscribe("fresh");
+    assert(fresh.GetPosition() == 0 && stream.GetCommittedOffset("fresh") == -1);
+
+    for (int i = 4; i < 12; ++i)
+    {
+        stream.Add("m" + std::to_string(i));
+    }
+    {
+        auto batch = resumed.Poll(100);
+        assert(batch.GetFirstOffset() == 7 && batch.GetLength() == 5);
+        assert(batch[4] == "m11" && batch.GetNextOffset() == 12);
+    }
+    resumed.Seek(9);
+    assert(resumed.Poll(1)[0] == "m9");
+    resumed.Seek(50);
+    assert(resumed.Poll(5).IsEmpty());
+
+    BufferedStream<int> shared;
+    const int total = 20000;
+    const int readers = 3;
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&, r]
+                             {
+                                 auto consumer = shared.Subscribe("reader" + std::to_string(r));
+                                 long long expected = 0;
+                                 while (expected < total)
+                                 {
+                                     auto batch = consumer.Poll(64);
+                                     assert(batch.IsEmpty() || batch.GetFirstOffset() == expected);
+                                     for (int i = 0; i < batch.GetLength(); ++i)
+                                     {
+                                         assert(batch[i] == expected++);
+                                     }
+                                     consumer.Commit();
+                                     if (batch.IsEmpty())
+                                         std::this_thread::yield();
+                                 }
+                                 finished.fetch_add(1);
+                             });
+    }
+    for (int i = 0; i < total; ++i)
+    {
+        shared.Add(i);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    assert(finished.load() == readers);
+    for (int r = 0; r < readers; ++r)
+    {
+        assert(shared.GetCommittedOffset("reader" + std::to_string(r)) == total);
+    }
+
+    std::cout << "StreamConsumers tests passed!" << std::endl;
+}
+
+void TestStreamCommitPaths()
+{
+    std::cout << "Testing StreamCommitPaths..." << std::endl;
+    BufferedStream<std::string> stream;
+    std::string large(1000, 'a');
+    const char *buffer = large.data();
+    stream.SetCurrent(std::move(large));
+    stream.CommitCurrentToBuffer();
+    assert(stream.GetAtOffset(0).data() == buffer);
+
+    std::string_view view("emplaced");
+    assert(stream.Emplace(view) == 1);
+    assert(stream.Emplace(3, 'z') == 2);
+    assert(stream.GetAtOffset(1) == "emplaced" && stream.GetAtOffset(2) == "zzz");
+
+    std::vector<std::string> batch;
+    std::vector<const char *> buffers;
+    for (int i = 0; i < 100; ++i)
+    {
+        batch.push_back(std::string(100, static_cast<char>('a' + i % 26)));
+        buffers.push_back(batch.back().data());
+    }
+    assert(stream.CommitBatch(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end())) == 3);
+    assert(stream.GetNextOffset() == 103);
+    for (int i = 0; i < 100; ++i)
+    {
+        assert(stream.GetAtOffset(3 + i).data() == buffers[i]);
+    }
+    std::vector<std::string> copied = {"x", "y"};
+    assert(stream.CommitBatch(copied.begin(), copied.end()) == 103);
+    assert(copied[0] == "x" && stream.GetLast() == "y");
+
+    auto consumer = stream.Subscribe("group");
+    consumer.Seek(stream.GetNextOffset());
+    stream.SetGroupCommit(4);
+    assert(stream.Add("g0") == 105);
+    assert(stream.Add("g1") == 106 && stream.Add("g2") == 107);
+    assert(stream.GetStagedCount() == 3 && stream.GetNextOffset() == 105);
+    assert(consumer.Poll(10).IsEmpty());
+    assert(stream.Add("g3") == 108);
+    assert(stream.GetStagedCount() == 0 && stream.GetNextOffset() == 109);
+    {
+        auto published = consumer.Poll(10);
+        assert(published.GetLength() == 4 && published[3] == "g3");
+    }
+    stream.Add("g4");
+    std::vector<std::string> after = {"b0"};
+    assert(stream.CommitBatch(after.begin(), after.end()) == 110);
+    assert(stream.GetAtOffset(109) == "g4");
+    stream.Add("g5");
+    stream.Flush();
+    assert(stream.GetLast() == "g5" && stream.GetStagedCount() == 0);
+    stream.Add("g6");
+    stream.InsertAtInPlace("front", 0);
+    assert(stream.GetFirst() == "front" && stream.GetLast() == "g6");
+    stream.SetGroupCommit(1);
+    assert(stream.Add("direct") == stream.GetNextOffset() - 1);
+
+    std::cout << "StreamCommitPaths tests passed!" << std::endl;
+}
+
+void TestSegmentLog()
+{
+    std::cout << "Testing SegmentLog..." << std::endl;
+    char directory[] = "/tmp/segment-log-test-XXXXXX";
+    assert(mkdtemp(directory) != nullptr);
+
+    SegmentLog::Options options;
+    options.directory = directory;
+    options.segmentBytes = 1024;
+    options.indexInterval = 64;
+    std::vector<std::string> written;
+    {
+        SegmentLog log(options);
+        assert(log.GetNextOffset() == 0 && log.GetSegmentCount() == 0);
+        for (int i = 0; i < 500; ++i)
+        {
+            written.push_back(std::string(i % 37, static_cast<char>('a' + i % 26)));
+            assert(log.Append(written.back()) == i);
+        }
+        written.push_back(std::string(3000, 'z'));
+        assert(log.Append(written.back()) == 500);
+        written.push_back("after");
+        assert(log.Append(written.back()) == 501);
+        assert(log.GetSegmentCount() > 10);
+
+        for (int i = 0; i < static_cast<int>(written.size()); ++i)
+        {
+            assert(log.Read(i) == written[i]);
+        }
+        long long expected = 100;
+        long long end = log.ForEach(100, 450, [&](long long offset, std::string_view record)
+                                    {
+                                        assert(offset == expected++);
+                                        assert(record == written[offset]);
+                                    });
+        assert(end == 450 && expected == 450);
+        try
+        {
+            log.Read(502);
+            assert(false);
+        }
+        catch (const std::out_of_range &)
+        {
+        }
+        log.Sync();
+    }
+
+    {
+        SegmentLog reopened(options);
+        assert(reopened.GetFirstOffset() == 0 && reopened.GetNextOffset() == 502);
+        assert(reopened.Read(250) == written[250] && reopened.Read(500) == written[500]);
+        assert(reopened.Append("resumed") == 502);
+        assert(reopened.Read(502) == "resumed");
+
+        int segments = reopened.GetSegmentCount();
+        reopened.DropBefore(300);
+        assert(reopened.GetSegmentCount() < segments);
+        assert(reopened.GetFirstOffset() > 0 && reopened.GetFirstOffset() <= 300);
+        assert(reopened.Read(300) == written[300]);
+        try
+        {
+            reopened.Read(0);
+            assert(false);
+        }
+        catch (const std::out_of_range &)
+        {
+        }
+    }
+
+    options.maxSegments = 2;
+    {
+        SegmentLog bounded(options);
+        for (int i = 0; i < 200; ++i)
+        {
+            bounded.Append(std::string(100, 'b'));
+        }
+        assert(bounded.GetSegmentCount() == 2);
+        assert(bounded.GetNextOffset() - bounded.GetFirstOffset() < 25);
+    }
+    options.maxSegments = 0;
+
+    // Sealing a segment shrinks its file, not its mapping, and all of the
+    // mapping must be released once the log is gone.
+    auto mappedBytes = [&]
+    {
+        std::ifstream maps("/proc/self/maps");
+        std::string line;
+        size_t total = 0;
+        while (std::getline(maps, line))
+        {
+            if (line.find(directory) == std::string::npos)
+                continue;
+            size_t dash = line.find('-');
+            total += std::stoull(line.substr(dash + 1, line.find(' ') - dash - 1), nullptr, 16) -
+                     std::stoull(line.substr(0, dash), nullptr, 16);
+        }
+        return total;
+    };
+    options.segmentBytes = 1 << 20;
+    {
+        SegmentLog sealed(options);
+        sealed.Append("small");
+        sealed.Append(std::string(options.segmentBytes, 'l'));
+        assert(mappedBytes() >= 2 * options.segmentBytes);
+    }
+    assert(mappedBytes() == 0);
+    options.segmentBytes = 1024;
+    std::filesystem::remove_all(directory);
+
+    RetentionPolicy hotTail;
+    hotTail.maxCount = 4;
+    char streamDirectory[] = "/tmp/segment-stream-test-XXXXXX";
+    assert(mkdtemp(streamDirectory) != nullptr);
+    options.directory = streamDirectory;
+    BufferedStream<std::string> spilled(hotTail, std::make_unique<SegmentLog>(options));
+    for (int i = 0; i < 100; ++i)
+    {
+        assert(spilled.Add("s" + std::to_string(i)) == i);
+    }
+    assert(spilled.GetLength() == 4 && spilled.GetFirstOffset() == 96);
+    assert(spilled.GetOldestOffset() == 0);
+    assert(spilled.ReadAtOffset(3) == "s3" && spilled.ReadAtOffset(98) == "s98");
+    assert(spilled.GetLog()->GetNextOffset() == 100);
+    try
+    {
+        spilled.InsertAtInPlace("x", 1);
+        assert(false);
+    }
+    catch (const std::logic_error &)
+    {
+    }
+
+    // A consumer behind the hot tail replays the log from the mapped
+    // segments, then carries on into memory.
+    auto replay = spilled.Subscribe("replay");
+    assert(replay.GetPosition() == 96);
+    replay.Seek(0);
+    long long next = 0;
+    while (true)
+    {
+        auto batch = replay.Poll(30);
+        if (batch.IsEmpty())
+            break;
+        assert(batch.GetFirstOffset() == next);
+        assert(batch.IsSpilled() == (next < 96));
+        assert(batch.GetNextOffset() <= 96 || next >= 96);
+        for (int i = 0; i < batch.GetLength(); ++i)
+        {
+            std::string expected = "s" + std::to_string(next + i);
+            assert(batch.View(i) == expected && batch[i] == expected);
+            if (batch.IsSpilled())
+                assert(batch.View(i).data() == spilled.GetLog()->Read(next + i).data());
+        }
+        next = batch.GetNextOffset();
+    }
+    assert(next == 100 && replay.GetPosition() == 100);
+
+    options.directory = std::string(streamDirectory) + "/numbers";
+    BufferedStream<int> numbers(hotTail, std::make_unique<SegmentLog>(options));
+    for (int i = 0; i < 10; ++i)
+    {
+        numbers.Add(i * i);
+    }
+    assert(numbers.ReadAtOffset(2) == 4 && numbers.ReadAtOffset(9) == 81);
+    auto squares = numbers.Subscribe("squares");
+    squares.Seek(0);
+    auto replayed = squares.Poll(100);
+    assert(replayed.IsSpilled() && replayed.GetLength() == 6 && replayed[5] == 25);
+    assert(squares.Poll(100).GetFirstOffset() == 6);
+
+    // A broker subscriber that starts behind a spilled topic's hot tail is
+    // sent the evicted messages from disk.
+    Broker::Options brokerOptions;
+    brokerOptions.server.port = 0;
+    brokerOptions.retention = hotTail;
+    brokerOptions.spillDirectory = std::string(streamDirectory) + "/broker";
+    brokerOptions.segmentBytes = 1024;
+    Broker broker(brokerOptions);
+    broker.Start();
+    for (int i = 0; i < 50; ++i)
+    {
+        broker.Publish("spilled", "p" + std::to_string(i));
+    }
+    int subscriber = ConnectLoopback(broker.GetPort());
+    std::string subscribe;
+    AppendTopicFrame(subscribe, FrameKind::Subscribe, "spilled", "", 0);
+    SendFrames(subscriber, subscribe);
+    std::vector<Delivery> deliveries = ReadDeliveries(subscriber, 50);
+    assert(deliveries.size() == 50);
+    for (int i = 0; i < 50; ++i)
+    {
+        assert(deliveries[i].offset == i && deliveries[i].body == "p" + std::to_string(i));
+    }
+    close(subscriber);
+    broker.Stop();
+    std::filesystem::remove_all(streamDirectory);
+
+    std::cout << "SegmentLog tests passed!" << std::endl;
+}
+
+void TestLatencyHistogram()
+{
+    std::cout << "Testing LatencyHistogram..." << std::endl;
+    LatencyHistogram histogram;
+    try
+    {
+        histogram.GetValueAtPercentile(50);
+        assert(false);
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+    for (uint64_t value = 1; value <= 100000; ++value)
+    {
+        histogram.Record(value * 1000);
+    }
+    assert(histogram.GetCount() == 100000);
+    assert(histogram.GetMin() == 1000 && histogram.GetMax() == 100000000);
+    assert(std::abs(histogram.GetMean() - 50000500.0) < 1);
+    for (double percentile : {1.0, 50.0, 90.0, 99.0, 99.9})
+    {
+        double exact = percentile * 1000000;
+        double reported = static_cast<double>(histogram.GetValueAtPercentile(percentile));
+        assert(reported >= exact && reported <= exact * (1 + 1.0 / 128));
+    }
+    assert(histogram.GetValueAtPercentile(100) == 100000000);
+    assert(histogram.GetValueAtPercentile(0) == 1003);
+
+    // Small values are exact, and the largest value still has a bucket.
+    LatencyHistogram other;
+    other.Record(0);
+    other.Record(5, 3);
+    other.Record(UINT64_MAX);
+    assert(other.GetValueAtPercentile(25) == 0 && other.GetValueAtPercentile(75) == 5);
+    assert(other.GetValueAtPercentile(100) == UINT64_MAX);
+    histogram.Merge(other);
+    assert(histogram.GetCount() == 100005 && histogram.GetMin() == 0 && histogram.GetMax() == UINT64_MAX);
+    try
+    {
+        histogram.Merge(LatencyHistogram(3));
+        assert(false);
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    histogram.Clear();
+    assert(histogram.GetCount() == 0);
+
+    std::cout << "LatencyHistogram tests passed!" << std::endl;
+}
+
 void TestSegmentedDeque()
 {
     std::cout << "Testing SegmentedDeque..." << std::endl;
@@ -427,6 +2930,32 @@ int main()
     TestListImmutableSequence();
     TestQueue();
     TestDeque();
+    TestPriorityQueue();
+    TestPriorityDeque();
+    TestIndexedPriorityQueue();
+    TestRadixHeap();
+    TestBucketQueue();
+    TestPairingHeap();
+    TestSpscRingQueue();
+    TestMpmcQueue();
+    TestWorkStealingDeque();
+    TestConcurrentSegmentedDeque();
+    TestConcurrentLogSequence();
+    TestSnapshotCell();
+    TestMonotonicDeque();
+    TestSlidingWindow();
+    TestTimerWheel();
+    TestRangeQuerySequence();
+    TestFraming();
+    TestStreamServer();
+    TestBroker();
+    TestBrokerBackpressure();
+    TestBrokerAcks();
+    TestBufferedStream();
+    TestStreamConsumers();
+    TestStreamCommitPaths();
+    TestSegmentLog();
+    TestLatencyHistogram();
     TestSegmentedDeque();
     
     std::cout << "All tests passed successfully!" << std::endl;